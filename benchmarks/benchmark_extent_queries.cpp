@@ -0,0 +1,269 @@
+// Internal headers.
+#include "boni/loose_quad_tree.hpp"
+#include "random_geometry.hpp"
+
+// Standard libraries.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+// C Standard libraries.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// Compares ways of finding rectangles overlapping query regions.
+//
+// Usage: quad-world-benchmark-extent-queries [box_count] [query_count]
+//
+// Rectangles have a wide range of sizes, so that many straddle
+// the quadrant boundaries of a region quad-tree.
+
+namespace {
+
+using boni::quad_tree::box;
+
+// Region quad-tree, where each object is stored in the deepest node
+// whose cell fully contains it.
+// Objects straddling a quadrant boundary stay in the parent,
+// however small they are.
+class region_tree {
+public:
+  void build(const std::vector<box>& new_boxes) {
+    nodes_.clear();
+    boxes_ = new_boxes;
+    if (boxes_.empty()) {
+      return;
+    }
+    auto bounds = boxes_.front();
+    for (const auto& object : boxes_) {
+      for (std::size_t axis = 0; axis < 2; ++axis) {
+        bounds.min[axis] =
+            std::min(bounds.min[axis], object.min[axis]);
+        bounds.max[axis] =
+            std::max(bounds.max[axis], object.max[axis]);
+      }
+    }
+    const auto side = std::max(
+        std::int64_t{bounds.max[0]} - bounds.min[0] + 1,
+        std::int64_t{bounds.max[1]} - bounds.min[1] + 1);
+    nodes_.push_back(
+        node{{bounds.min[0], bounds.min[1]}, side, 0, 0,
+             boxes_.size()});
+    split(0);
+  }
+
+  template <typename callback_t>
+  void for_each_overlapping(
+      const box& query, callback_t&& callback) const {
+    if (!nodes_.empty()) {
+      for_each_overlapping_under(0, query, callback);
+    }
+  }
+
+  // Returns the share of objects stored in the root.
+  auto root_share() const -> double {
+    const auto& root = nodes_.front();
+    return static_cast<double>(root.own_end - root.begin) /
+           static_cast<double>(boxes_.size());
+  }
+
+private:
+  struct node {
+    std::array<std::int64_t, 2> cell_min;
+    std::int64_t side;
+    std::size_t begin;
+    std::size_t own_end;
+    std::size_t end;
+    std::size_t first_child{};
+    std::size_t child_count{};
+  };
+
+  static constexpr std::size_t leaf_capacity = 8;
+
+  template <typename predicate_t>
+  auto partition(
+      std::size_t begin, std::size_t end, predicate_t predicate)
+      -> std::size_t {
+    const auto middle = std::partition(
+        boxes_.begin() + static_cast<std::ptrdiff_t>(begin),
+        boxes_.begin() + static_cast<std::ptrdiff_t>(end), predicate);
+    return static_cast<std::size_t>(middle - boxes_.begin());
+  }
+
+  void split(std::size_t node_index) {
+    const auto current = nodes_[node_index];
+    if (current.end - current.begin <= leaf_capacity ||
+        current.side <= 1) {
+      nodes_[node_index].own_end = current.end;
+      return;
+    }
+    const auto half = (current.side + 1) / 2;
+    const auto middle_x = current.cell_min[0] + half;
+    const auto middle_y = current.cell_min[1] + half;
+    const auto own_end =
+        partition(current.begin, current.end, [&](const box& object) {
+          // Straddles the boundary between quadrants.
+          return (object.min[0] < middle_x) !=
+                     (object.max[0] < middle_x) ||
+                 (object.min[1] < middle_y) !=
+                     (object.max[1] < middle_y);
+        });
+    const auto split_x =
+        partition(own_end, current.end, [&](const box& object) {
+          return object.min[0] < middle_x;
+        });
+    const auto is_low_y = [&](const box& object) {
+      return object.min[1] < middle_y;
+    };
+    const auto split_low_y = partition(own_end, split_x, is_low_y);
+    const auto split_high_y =
+        partition(split_x, current.end, is_low_y);
+    const std::array<std::size_t, 5> boundaries{
+        own_end, split_low_y, split_x, split_high_y, current.end};
+    const std::array<std::array<std::int64_t, 2>, 4> child_cell_mins{{
+        {current.cell_min[0], current.cell_min[1]},
+        {current.cell_min[0], middle_y},
+        {middle_x, current.cell_min[1]},
+        {middle_x, middle_y},
+    }};
+
+    nodes_[node_index].own_end = own_end;
+    const auto first_child = nodes_.size();
+    for (std::size_t quadrant = 0; quadrant < 4; ++quadrant) {
+      const auto begin = boundaries[quadrant];
+      const auto end = boundaries[quadrant + 1];
+      if (begin != end) {
+        nodes_.push_back(
+            node{child_cell_mins[quadrant], half, begin, begin, end});
+      }
+    }
+    const auto child_count = nodes_.size() - first_child;
+    nodes_[node_index].first_child = first_child;
+    nodes_[node_index].child_count = child_count;
+    for (auto child = first_child; child < first_child + child_count;
+         ++child) {
+      split(child);
+    }
+  }
+
+  template <typename callback_t>
+  void for_each_overlapping_under(
+      std::size_t node_index, const box& query,
+      callback_t& callback) const {
+    const auto& current = nodes_[node_index];
+    const auto cell_max_x = current.cell_min[0] + current.side - 1;
+    const auto cell_max_y = current.cell_min[1] + current.side - 1;
+    if (query.max[0] < current.cell_min[0] ||
+        cell_max_x < query.min[0] ||
+        query.max[1] < current.cell_min[1] ||
+        cell_max_y < query.min[1]) {
+      return;
+    }
+    for (auto index = current.begin; index < current.own_end;
+         ++index) {
+      if (boni::quad_tree::overlaps(boxes_[index], query)) {
+        callback(index);
+      }
+    }
+    const auto children_end =
+        current.first_child + current.child_count;
+    for (auto child = current.first_child; child < children_end;
+         ++child) {
+      for_each_overlapping_under(child, query, callback);
+    }
+  }
+
+  std::vector<node> nodes_;
+  std::vector<box> boxes_;
+};
+
+auto count_overlapping_brute_force(
+    const std::vector<box>& boxes, const std::vector<box>& queries)
+    -> std::size_t {
+  auto count = std::size_t{0};
+  for (const auto& query : queries) {
+    for (const auto& object : boxes) {
+      count += boni::quad_tree::overlaps(object, query) ? 1 : 0;
+    }
+  }
+  return count;
+}
+
+template <typename tree_t>
+auto count_overlapping(
+    const tree_t& index, const std::vector<box>& queries)
+    -> std::size_t {
+  auto count = std::size_t{0};
+  for (const auto& query : queries) {
+    index.for_each_overlapping(
+        query, [&count](std::size_t /*object*/) { ++count; });
+  }
+  return count;
+}
+
+template <typename function_t>
+void report(const char* name, function_t&& function) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto count = function();
+  const auto stop = std::chrono::steady_clock::now();
+  const auto milliseconds =
+      std::chrono::duration<double, std::milli>(stop - start).count();
+  std::printf(
+      "%-24s %12zu boxes %10.2f ms\n", name, count, milliseconds);
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+  const auto box_count =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+  const auto query_count =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+  constexpr auto extent = 1 << 15;
+  constexpr auto max_box_size = 1 << 12;
+  constexpr auto query_size = 1 << 11;
+  const auto boxes =
+      make_random_boxes(box_count, extent, max_box_size, 0);
+  auto queries = make_random_boxes(query_count, extent, 0, 1);
+  for (auto& query : queries) {
+    query.max = {
+        query.min[0] + query_size, query.min[1] + query_size};
+  }
+  std::printf(
+      "%zu boxes, %zu queries of width %d in [-%d, %d]^2\n",
+      static_cast<std::size_t>(box_count),
+      static_cast<std::size_t>(query_count), query_size, extent,
+      extent);
+
+  auto loose_index = boni::quad_tree::loose_tree{};
+  auto region_index = region_tree{};
+  report("loose tree build", [&] {
+    loose_index.build(boxes);
+    return loose_index.boxes().size();
+  });
+  report("region tree build", [&] {
+    region_index.build(boxes);
+    return boxes.size();
+  });
+  const auto& loose_root = loose_index.nodes().front();
+  std::printf(
+      "objects in root: loose %.2f%%, region %.2f%%\n",
+      100.0 *
+          static_cast<double>(loose_root.own_end - loose_root.begin) /
+          static_cast<double>(boxes.size()),
+      100.0 * region_index.root_share());
+
+  report("brute force queries", [&] {
+    return count_overlapping_brute_force(boxes, queries);
+  });
+  report("region tree queries", [&] {
+    return count_overlapping(region_index, queries);
+  });
+  report("loose tree queries", [&] {
+    return count_overlapping(loose_index, queries);
+  });
+  return 0;
+}
@@ -0,0 +1,185 @@
+// Internal headers.
+#include "boni/quad_tree.hpp"
+#include "random_geometry.hpp"
+
+// Standard libraries.
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// C Standard libraries.
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// Compares ways of finding every pair of points within a radius.
+//
+// Usage: quad-world-benchmark-neighbour-pairs [point_count] [radius]
+//
+// Each method only counts the pairs it finds,
+// so that the timings are of the search and not of storing results.
+
+namespace {
+
+using boni::quad_tree::point;
+
+auto count_pairs_brute_force(
+    const std::vector<point>& points, int radius) -> std::size_t {
+  const auto radius_squared = std::int64_t{radius} * radius;
+  auto count = std::size_t{0};
+  for (std::size_t first = 0; first < points.size(); ++first) {
+    for (auto second = first + 1; second < points.size(); ++second) {
+      if (boni::quad_tree::distance_squared(
+              points[first], points[second]) <= radius_squared) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+// Uniform grid with cells of width `radius`.
+// Points are bucketed by sorting on their cell,
+// and each cell is compared with itself and four of its neighbours.
+auto count_pairs_uniform_grid(
+    const std::vector<point>& points, int radius) -> std::size_t {
+  const auto cell_width = std::max(radius, 1);
+  // Rounds down, so that cells either side of zero are as wide
+  // as the others.
+  const auto floor_cell = [cell_width](int coordinate) {
+    const auto quotient = coordinate / cell_width;
+    return std::int64_t{quotient} -
+           (coordinate % cell_width < 0 ? 1 : 0);
+  };
+  // Linear in both cells, so that neighbours are at fixed offsets.
+  // Multiplied rather than shifted, since cells may be negative.
+  constexpr auto row_stride = std::int64_t{1} << 32;
+  const auto cell_of = [&](point position) -> std::int64_t {
+    return floor_cell(position[0]) * row_stride +
+           floor_cell(position[1]);
+  };
+  auto order = std::vector<std::size_t>(points.size());
+  for (std::size_t index = 0; index < order.size(); ++index) {
+    order[index] = index;
+  }
+  std::sort(order.begin(), order.end(), [&](auto left, auto right) {
+    return cell_of(points[left]) < cell_of(points[right]);
+  });
+  using range_type = std::pair<std::size_t, std::size_t>;
+  auto cells = std::unordered_map<std::int64_t, range_type>{};
+  for (std::size_t begin = 0; begin < order.size();) {
+    const auto cell = cell_of(points[order[begin]]);
+    auto end = begin + 1;
+    while (end < order.size() && cell_of(points[order[end]]) == cell) {
+      ++end;
+    }
+    cells.emplace(cell, std::make_pair(begin, end));
+    begin = end;
+  }
+
+  const auto radius_squared = std::int64_t{radius} * radius;
+  const std::int64_t neighbour_offsets[] = {
+      row_stride - 1, row_stride, row_stride + 1, 1};
+  auto count = std::size_t{0};
+  for (const auto& [cell, range] : cells) {
+    for (auto first = range.first; first < range.second; ++first) {
+      for (auto second = first + 1; second < range.second; ++second) {
+        if (boni::quad_tree::distance_squared(
+                points[order[first]], points[order[second]]) <=
+            radius_squared) {
+          ++count;
+        }
+      }
+    }
+    for (const auto offset : neighbour_offsets) {
+      const auto neighbour = cells.find(cell + offset);
+      if (neighbour == cells.end()) {
+        continue;
+      }
+      const auto& other = neighbour->second;
+      for (auto first = range.first; first < range.second; ++first) {
+        for (auto second = other.first; second < other.second;
+             ++second) {
+          if (boni::quad_tree::distance_squared(
+                  points[order[first]], points[order[second]]) <=
+              radius_squared) {
+            ++count;
+          }
+        }
+      }
+    }
+  }
+  return count;
+}
+
+auto count_pairs_quad_tree(
+    const std::vector<point>& points, int radius, unsigned worker_count)
+    -> std::size_t {
+  auto index = boni::quad_tree::tree{};
+  index.build(points);
+  // Padded so that workers do not share cache lines.
+  struct alignas(64) counter {
+    std::size_t value{};
+  };
+  auto counts = std::vector<counter>(std::max(worker_count, 1U));
+  boni::quad_tree::for_each_pair_within(
+      index, radius,
+      [&counts](std::size_t worker, std::size_t, std::size_t) {
+        ++counts[worker].value;
+      },
+      worker_count);
+  auto count = std::size_t{0};
+  for (const auto& worker_counter : counts) {
+    count += worker_counter.value;
+  }
+  return count;
+}
+
+template <typename function_t>
+void report(const char* name, function_t&& function) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto count = function();
+  const auto stop = std::chrono::steady_clock::now();
+  const auto milliseconds =
+      std::chrono::duration<double, std::milli>(stop - start).count();
+  std::printf(
+      "%-24s %12zu pairs %10.2f ms\n", name, count, milliseconds);
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+  const auto point_count =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+  const auto radius = argc > 2 ? std::atoi(argv[2]) : 16;
+  // Keeps the average number of neighbours per point roughly constant
+  // as the point count changes.
+  const auto extent = static_cast<int>(
+      std::sqrt(static_cast<double>(point_count)) * 32);
+  const auto points = make_random_points(point_count, extent, 0);
+  const auto worker_count =
+      std::max(std::thread::hardware_concurrency(), 1U);
+
+  std::printf(
+      "%zu points in [-%d, %d]^2, radius %d, %u workers\n",
+      static_cast<std::size_t>(point_count), extent, extent, radius,
+      worker_count);
+  report("brute force", [&] {
+    return count_pairs_brute_force(points, radius);
+  });
+  report("uniform grid", [&] {
+    return count_pairs_uniform_grid(points, radius);
+  });
+  report("quad-tree, 1 worker", [&] {
+    return count_pairs_quad_tree(points, radius, 1);
+  });
+  report("quad-tree, all workers", [&] {
+    return count_pairs_quad_tree(points, radius, worker_count);
+  });
+  return 0;
+}
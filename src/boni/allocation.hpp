@@ -0,0 +1,176 @@
+#pragma once
+
+// Standard library.
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+
+/** \brief Contains allocation accounting utilities. */
+namespace boni::allocation {
+
+/** \brief A snapshot of the values of a `counter`. */
+struct statistics {
+  /** \brief Bytes currently allocated. */
+  std::size_t live_bytes{};
+  /** \brief Largest value `live_bytes` has reached. */
+  std::size_t peak_bytes{};
+  /** \brief Number of allocations made so far. */
+  std::size_t allocation_count{};
+};
+
+/** \brief Tracks allocated bytes of a subsystem.
+ *
+ *  Updates are atomic so that allocations from different threads
+ *  can be recorded to the same counter.
+ */
+class counter {
+public:
+  /** \brief Records an allocation of the given size. */
+  void on_allocate(std::size_t byte_count) {
+    allocation_count_.fetch_add(1, std::memory_order_relaxed);
+    const auto live = live_bytes_.fetch_add(
+                          byte_count, std::memory_order_relaxed) +
+                      byte_count;
+    auto peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (peak < live && !peak_bytes_.compare_exchange_weak(
+                              peak, live, std::memory_order_relaxed)) {
+    }
+  }
+
+  /** \brief Records a deallocation of the given size. */
+  void on_deallocate(std::size_t byte_count) {
+    live_bytes_.fetch_sub(byte_count, std::memory_order_relaxed);
+  }
+
+  /** \brief Returns the current values. */
+  auto load() const -> statistics {
+    return {
+        live_bytes_.load(std::memory_order_relaxed),
+        peak_bytes_.load(std::memory_order_relaxed),
+        allocation_count_.load(std::memory_order_relaxed)};
+  }
+
+  /** \brief Lowers the peak to the current live bytes. */
+  void reset_peak() {
+    peak_bytes_.store(
+        live_bytes_.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::size_t> live_bytes_{0};
+  std::atomic<std::size_t> peak_bytes_{0};
+  std::atomic<std::size_t> allocation_count_{0};
+};
+
+/** \brief The counter that allocations tagged with `tag_t` record to.
+ *
+ *  \tparam tag_t
+ *          Any type, typically an empty struct naming a subsystem.
+ */
+template <typename tag_t> inline counter counter_of{};
+
+/** \brief An `Allocator` that records to `counter_of<tag_t>`.
+ *
+ *  \tparam value_t
+ *          The type of objects allocated.
+ *  \tparam tag_t
+ *          The subsystem the allocations are accounted to.
+ *
+ *  Memory is obtained from `std::allocator`.
+ *  The allocator is stateless, so that containers using it
+ *  have the same size as those using `std::allocator`.
+ *
+ *  ```cpp
+ *  struct render_cache {};
+ *  std::vector<int, counting_allocator<int, render_cache>> values;
+ *  values.resize(16);
+ *  counter_of<render_cache>.load().live_bytes; // 64
+ *  ```
+ */
+template <typename value_t, typename tag_t> class counting_allocator {
+public:
+  /** \brief The type of objects allocated. */
+  using value_type = value_t;
+
+  /** \brief Allocators with different `value_t` rebind to this. */
+  template <typename other_t> struct rebind {
+    using other = counting_allocator<other_t, tag_t>;
+  };
+
+  counting_allocator() = default;
+
+  /** \brief Converts from the allocator for another type.
+   *
+   *  This is required of `Allocator` for rebinding.
+   */
+  template <typename other_t>
+  counting_allocator(
+      const counting_allocator<other_t, tag_t>& /*other*/) {}
+
+  /** \brief Allocates storage for `count` objects. */
+  auto allocate(std::size_t count) -> value_type* {
+    auto* const result = std::allocator<value_type>{}.allocate(count);
+    counter_of<tag_t>.on_allocate(count * sizeof(value_type));
+    return result;
+  }
+
+  /** \brief Releases storage from `allocate`. */
+  void deallocate(value_type* pointer, std::size_t count) {
+    counter_of<tag_t>.on_deallocate(count * sizeof(value_type));
+    std::allocator<value_type>{}.deallocate(pointer, count);
+  }
+
+  /** \brief Stateless allocators of the same tag are interchangeable. */
+  template <typename other_t>
+  friend auto operator==(
+      const counting_allocator& /*left*/,
+      const counting_allocator<other_t, tag_t>& /*right*/) -> bool {
+    return true;
+  }
+
+  /** \brief Stateless allocators of the same tag are interchangeable. */
+  template <typename other_t>
+  friend auto operator!=(
+      const counting_allocator& left,
+      const counting_allocator<other_t, tag_t>& right) -> bool {
+    return !(left == right);
+  }
+};
+
+/** \brief Allocates with `std::malloc`, recording to `target`.
+ *
+ *  This is for C style allocation hooks,
+ *  whose free function is not told the size of the allocation.
+ *  The size is stored in a header in front of the returned block.
+ *  The result must be released with `free_counted`.
+ */
+inline auto malloc_counted(counter& target, std::size_t byte_count)
+    -> void* {
+  constexpr auto header_size = alignof(std::max_align_t);
+  auto* const block = static_cast<unsigned char*>(
+      std::malloc(header_size + byte_count));
+  if (block == nullptr) {
+    return nullptr;
+  }
+  *reinterpret_cast<std::size_t*>(block) = byte_count;
+  target.on_allocate(byte_count);
+  return block + header_size;
+}
+
+/** \brief Releases memory from `malloc_counted`.
+ *
+ *  Does nothing if `pointer` is null, like `std::free`.
+ */
+inline void free_counted(counter& target, void* pointer) {
+  if (pointer == nullptr) {
+    return;
+  }
+  constexpr auto header_size = alignof(std::max_align_t);
+  auto* const block = static_cast<unsigned char*>(pointer) - header_size;
+  target.on_deallocate(*reinterpret_cast<std::size_t*>(block));
+  std::free(block);
+}
+
+} // namespace boni::allocation
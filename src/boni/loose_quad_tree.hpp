@@ -0,0 +1,308 @@
+#pragma once
+
+// Internal headers.
+#include "./quad_tree.hpp"
+
+// Standard library.
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace boni::quad_tree {
+
+/** \brief Returns whether two boxes share at least one point. */
+inline auto overlaps(const box& left, const box& right) -> bool {
+  return left.min[0] <= right.max[0] && right.min[0] <= left.max[0] &&
+         left.min[1] <= right.max[1] && right.min[1] <= left.max[1];
+}
+
+/** \brief Loose quad-tree of objects with extents,
+ *         rebuilt in bulk from their bounding boxes.
+ *
+ *  Each node covers a square cell, split into four quadrants.
+ *  An object is stored in exactly one node:
+ *  the deepest one whose cell contains its centre
+ *  and whose quadrants are narrower than the object.
+ *  So, unlike a region quad-tree, an object straddling
+ *  a quadrant boundary does not get stuck near the root
+ *  or duplicated into every quadrant it overlaps.
+ *  Objects stored in a node lie within its cell
+ *  grown by half the cell width on each side,
+ *  which is what makes the tree "loose".
+ *
+ *  Nodes record the tight bounds of all objects under them,
+ *  which are never larger than the loose cell,
+ *  and queries prune by those.
+ *
+ *  Boxes are copied into a single array,
+ *  reordered so that the objects under every node
+ *  form one contiguous range.
+ *  Queries report objects by their index in the list given to `build`.
+ *
+ *  \tparam allocator_t
+ *          Allocator for the copied boxes,
+ *          rebound for the node and index arrays.
+ */
+template <typename allocator_t = std::allocator<box>>
+class basic_loose_tree {
+  template <typename value_t>
+  using vector = std::vector<
+      value_t, typename std::allocator_traits<
+                   allocator_t>::template rebind_alloc<value_t>>;
+
+public:
+  /** \brief A node of the tree.
+   *
+   *  The children of a node, if any, are stored contiguously
+   *  in `nodes()`, starting from `first_child`.
+   *  Empty quadrants have no child node.
+   */
+  struct node {
+    /** \brief Tight bounds of all objects under this node. */
+    box bounds;
+    /** \brief Start of the objects under this node in `boxes()`. */
+    std::size_t begin{};
+    /** \brief End of the objects stored in this node itself.
+     *
+     *  Objects from here to `end` are stored in descendants.
+     */
+    std::size_t own_end{};
+    /** \brief End of the objects under this node in `boxes()`. */
+    std::size_t end{};
+    /** \brief Index of the first child in `nodes()`. */
+    std::size_t first_child{};
+    /** \brief Number of children. Zero for a leaf. */
+    std::size_t child_count{};
+  };
+
+  /** \brief Number of objects above which a node is split. */
+  static constexpr std::size_t default_leaf_capacity = 8;
+
+  basic_loose_tree() = default;
+
+  /** \brief Sets the number of objects above which a node is split. */
+  explicit basic_loose_tree(std::size_t leaf_capacity)
+      : leaf_capacity_{std::max<std::size_t>(leaf_capacity, 1)} {}
+
+  /** \brief Replaces the content of the tree with the given boxes.
+   *
+   *  \param new_boxes
+   *         A contiguous container of `box`, such as `std::vector`.
+   *         Each box must have `min` no greater than `max`.
+   *
+   *  There is no update in place, so any change to the boxes
+   *  means a rebuild, which overwrites the arrays of the last one.
+   */
+  template <typename boxes_t = std::vector<box>>
+  void build(const boxes_t& new_boxes) {
+    nodes_.clear();
+    boxes_.assign(new_boxes.cbegin(), new_boxes.cend());
+    indices_.resize(new_boxes.size());
+    for (std::size_t index = 0; index < indices_.size(); ++index) {
+      indices_[index] = index;
+    }
+    if (boxes_.empty()) {
+      return;
+    }
+
+    auto centre_min = centre_of(boxes_.front());
+    auto centre_max = centre_min;
+    auto max_extent = std::int64_t{0};
+    for (const auto& object : boxes_) {
+      const auto centre = centre_of(object);
+      for (std::size_t axis = 0; axis < 2; ++axis) {
+        centre_min[axis] = std::min(centre_min[axis], centre[axis]);
+        centre_max[axis] = std::max(centre_max[axis], centre[axis]);
+      }
+      max_extent = std::max(max_extent, extent_of(object));
+    }
+    const auto side = std::max(
+        {centre_max[0] - centre_min[0] + 1,
+         centre_max[1] - centre_min[1] + 1, max_extent,
+         std::int64_t{1}});
+    nodes_.push_back(node{{}, 0, 0, boxes_.size()});
+    split(0, centre_min, side);
+  }
+
+  /** \brief Returns whether there are no objects in the tree. */
+  auto empty() const -> bool { return boxes_.empty(); }
+
+  /** \brief Returns all nodes. The root, if any, is the first. */
+  auto nodes() const -> const vector<node>& { return nodes_; }
+
+  /** \brief Returns the stored boxes, in tree order. */
+  auto boxes() const -> const vector<box>& { return boxes_; }
+
+  /** \brief Maps from tree order to the index given to `build`. */
+  auto indices() const -> const vector<std::size_t>& {
+    return indices_;
+  }
+
+  /** \brief Calls `callback(index)` for every object
+   *         whose box overlaps `query`.
+   *
+   *  This serves both culling, with the visible region as `query`,
+   *  and picking, with a box around the picked point.
+   */
+  template <typename callback_t>
+  void for_each_overlapping(
+      const box& query, callback_t&& callback) const {
+    if (!nodes_.empty()) {
+      for_each_overlapping_under(0, query, callback);
+    }
+  }
+
+private:
+  using cell_point = std::array<std::int64_t, 2>;
+
+  static auto centre_of(const box& object) -> cell_point {
+    return {
+        (std::int64_t{object.min[0]} + object.max[0]) / 2,
+        (std::int64_t{object.min[1]} + object.max[1]) / 2};
+  }
+
+  static auto extent_of(const box& object) -> std::int64_t {
+    return std::max(
+        std::int64_t{object.max[0]} - object.min[0],
+        std::int64_t{object.max[1]} - object.min[1]);
+  }
+
+  void swap_objects(std::size_t left, std::size_t right) {
+    std::swap(boxes_[left], boxes_[right]);
+    std::swap(indices_[left], indices_[right]);
+  }
+
+  /** \brief Moves objects satisfying `predicate` to the front.
+   *
+   *  Returns the end of the moved range.
+   */
+  template <typename predicate_t>
+  auto partition(
+      std::size_t begin, std::size_t end, predicate_t predicate)
+      -> std::size_t {
+    auto boundary = begin;
+    for (auto index = begin; index < end; ++index) {
+      if (predicate(boxes_[index])) {
+        swap_objects(index, boundary);
+        ++boundary;
+      }
+    }
+    return boundary;
+  }
+
+  /** \brief Distributes the objects of a node and computes its bounds.
+   *
+   *  \param cell_min
+   *         Corner of the square cell of the node.
+   *  \param side
+   *         Width of the cell.
+   *         Every object under the node has its centre in the cell,
+   *         and is no wider than it.
+   */
+  void split(
+      std::size_t node_index, cell_point cell_min, std::int64_t side) {
+    const auto begin = nodes_[node_index].begin;
+    const auto end = nodes_[node_index].end;
+    auto own_end = end;
+    const auto half = (side + 1) / 2;
+    if (end - begin > leaf_capacity_ && side > 1) {
+      // Objects wider than a quadrant stay in this node.
+      own_end = partition(begin, end, [half](const box& object) {
+        return extent_of(object) > half;
+      });
+    }
+    nodes_[node_index].own_end = own_end;
+
+    if (own_end != end) {
+      const auto middle_x = cell_min[0] + half;
+      const auto middle_y = cell_min[1] + half;
+      const auto is_low_x = [middle_x](const box& object) {
+        return centre_of(object)[0] < middle_x;
+      };
+      const auto is_low_y = [middle_y](const box& object) {
+        return centre_of(object)[1] < middle_y;
+      };
+      const auto split_x = partition(own_end, end, is_low_x);
+      const auto split_low_y = partition(own_end, split_x, is_low_y);
+      const auto split_high_y = partition(split_x, end, is_low_y);
+      const std::array<std::size_t, 5> boundaries{
+          own_end, split_low_y, split_x, split_high_y, end};
+      const std::array<cell_point, 4> child_cell_mins{
+          cell_point{cell_min[0], cell_min[1]},
+          cell_point{cell_min[0], middle_y},
+          cell_point{middle_x, cell_min[1]},
+          cell_point{middle_x, middle_y}};
+
+      const auto first_child = nodes_.size();
+      auto child_cells = std::array<cell_point, 4>{};
+      for (std::size_t quadrant = 0; quadrant < 4; ++quadrant) {
+        const auto child_begin = boundaries[quadrant];
+        const auto child_end = boundaries[quadrant + 1];
+        if (child_begin != child_end) {
+          child_cells[nodes_.size() - first_child] =
+              child_cell_mins[quadrant];
+          nodes_.push_back(node{{}, child_begin, 0, child_end});
+        }
+      }
+      const auto child_count = nodes_.size() - first_child;
+      nodes_[node_index].first_child = first_child;
+      nodes_[node_index].child_count = child_count;
+      for (std::size_t child = 0; child < child_count; ++child) {
+        split(first_child + child, child_cells[child], half);
+      }
+    }
+
+    auto bounds = boxes_[begin];
+    for (auto index = begin + 1; index < own_end; ++index) {
+      bounds = merge(bounds, boxes_[index]);
+    }
+    const auto& parent = nodes_[node_index];
+    const auto first_child = parent.first_child;
+    const auto children_end = first_child + parent.child_count;
+    for (auto child = first_child; child < children_end; ++child) {
+      bounds = merge(bounds, nodes_[child].bounds);
+    }
+    nodes_[node_index].bounds = bounds;
+  }
+
+  static auto merge(const box& left, const box& right) -> box {
+    return {
+        {std::min(left.min[0], right.min[0]),
+         std::min(left.min[1], right.min[1])},
+        {std::max(left.max[0], right.max[0]),
+         std::max(left.max[1], right.max[1])}};
+  }
+
+  template <typename callback_t>
+  void for_each_overlapping_under(
+      std::size_t node_index, const box& query,
+      callback_t& callback) const {
+    const auto& current = nodes_[node_index];
+    if (!overlaps(current.bounds, query)) {
+      return;
+    }
+    for (auto index = current.begin; index < current.own_end; ++index) {
+      if (overlaps(boxes_[index], query)) {
+        callback(indices_[index]);
+      }
+    }
+    const auto first_child = current.first_child;
+    const auto children_end = first_child + current.child_count;
+    for (auto child = first_child; child < children_end; ++child) {
+      for_each_overlapping_under(child, query, callback);
+    }
+  }
+
+  std::size_t leaf_capacity_{default_leaf_capacity};
+  vector<node> nodes_;
+  vector<box> boxes_;
+  vector<std::size_t> indices_;
+};
+
+/** \brief A `basic_loose_tree` using `std::allocator`. */
+using loose_tree = basic_loose_tree<>;
+
+} // namespace boni::quad_tree
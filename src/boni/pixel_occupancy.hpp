@@ -0,0 +1,334 @@
+#pragma once
+
+// Internal headers.
+#include "./worker_pool.hpp"
+
+// Standard library.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/** \brief Contains a screen-sized occupancy grid
+ *         for drawing each pixel at most once.
+ */
+namespace boni::pixel_occupancy {
+
+/** \brief Column and row of a pixel. */
+using pixel = std::array<int, 2>;
+
+/** \brief Largest number of intensity levels a `basic_grid` tracks. */
+constexpr std::size_t max_level_count = 8;
+
+/** \brief Marks the pixels hit by a set of points,
+ *         and lists every hit pixel once.
+ *
+ *  When zoomed out, far more points than pixels may be visible.
+ *  Marking them in a bitmap the size of the screen
+ *  bounds the output by the pixel count instead of the point count.
+ *
+ *  Each worker marks into its own bitmap, so marking needs no atomics.
+ *  The bitmaps are then merged a band of rows at a time.
+ *
+ *  Optionally, hits per pixel are counted, saturating at 255,
+ *  and pixels are grouped into intensity levels by that count:
+ *  level `n` holds pixels with `2^n` to `2^(n+1) - 1` hits,
+ *  and the last level also holds everything above.
+ *
+ *  \tparam allocator_t
+ *          Allocator for the words of the bitmaps,
+ *          rebound for the hit counts and the band offsets.
+ *          The bitmaps dominate, at one bit per pixel and worker,
+ *          unless hits are counted, at one byte each.
+ */
+template <typename allocator_t = std::allocator<std::uint64_t>>
+class basic_grid {
+  template <typename value_t>
+  using vector = std::vector<
+      value_t, typename std::allocator_traits<
+                   allocator_t>::template rebind_alloc<value_t>>;
+
+public:
+  /** \brief Number of points a worker marks before taking more. */
+  static constexpr std::size_t points_per_chunk = std::size_t{1} << 14;
+  /** \brief Number of rows a worker merges or lists at once. */
+  static constexpr int rows_per_band = 16;
+
+  /** \brief Returns the number of columns. */
+  auto width() const -> int { return width_; }
+
+  /** \brief Returns the number of rows. */
+  auto height() const -> int { return height_; }
+
+  /** \brief Returns the number of intensity levels. */
+  auto level_count() const -> std::size_t { return level_count_; }
+
+  /** \brief Clears all marks and sets the size of the grid.
+   *
+   *  \param level_count
+   *         Number of intensity levels, at most `max_level_count`.
+   *         With a single level, hits are not counted.
+   *
+   *  The bitmaps keep their size and contents until `mark`,
+   *  which clears them once it knows how many workers take part.
+   */
+  void reset(int width, int height, std::size_t level_count = 1) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    level_count_ =
+        std::clamp<std::size_t>(level_count, 1, max_level_count);
+    words_per_row_ = (static_cast<std::size_t>(width_) + 63) / 64;
+    words_per_worker_ = words_per_row_ * height_;
+    pixels_per_worker_ = static_cast<std::size_t>(width_) * height_;
+    const auto band_count =
+        static_cast<std::size_t>(height_ + rows_per_band - 1) /
+        rows_per_band;
+    band_offsets_.assign(band_count * level_count_, 0);
+    level_sizes_.assign(level_count_, 0);
+  }
+
+  /** \brief Marks the pixel of every point.
+   *
+   *  \param point_count
+   *         Number of points, indexed from zero.
+   *  \param pixel_of
+   *         Called as `pixel_of(index)`,
+   *         returning a `std::optional<pixel>`.
+   *         Points without a pixel, or outside the grid, are skipped.
+   *         It is called concurrently from several threads.
+   *  \param workers
+   *         The threads to split the work across.
+   *         Each worker that takes part has a bitmap of its own.
+   *
+   *  Called once after each `reset`.
+   *  Only the bitmaps of workers that take part are cleared,
+   *  so few points cost little however many workers there are,
+   *  and each worker clears its own, so clearing runs in parallel.
+   */
+  template <typename pixel_of_t>
+  void mark(
+      std::size_t point_count, pixel_of_t&& pixel_of,
+      parallel::worker_pool& workers) {
+    const auto chunk_count =
+        (point_count + points_per_chunk - 1) / points_per_chunk;
+    const auto thread_count = std::clamp<std::size_t>(
+        chunk_count, 1, workers.worker_count());
+    bits_.resize(thread_count * words_per_worker_);
+    hits_.resize(is_counting() ? thread_count * pixels_per_worker_ : 0);
+
+    std::atomic<std::size_t> next_point{0};
+    auto work = [&](std::size_t worker) {
+      auto* const bits = bits_.data() + worker * words_per_worker_;
+      std::fill_n(bits, words_per_worker_, std::uint64_t{0});
+      auto* const hits =
+          is_counting() ? hits_.data() + worker * pixels_per_worker_
+                        : nullptr;
+      if (hits != nullptr) {
+        std::fill_n(hits, pixels_per_worker_, std::uint8_t{0});
+      }
+      while (true) {
+        const auto chunk_begin = next_point.fetch_add(points_per_chunk);
+        if (chunk_begin >= point_count) {
+          return;
+        }
+        const auto chunk_end =
+            std::min(chunk_begin + points_per_chunk, point_count);
+        for (auto index = chunk_begin; index < chunk_end; ++index) {
+          const std::optional<pixel> target = pixel_of(index);
+          if (!target || !contains(*target)) {
+            continue;
+          }
+          const auto x = static_cast<std::size_t>((*target)[0]);
+          const auto y = static_cast<std::size_t>((*target)[1]);
+          bits[y * words_per_row_ + x / 64] |= std::uint64_t{1}
+                                               << (x % 64);
+          if (hits != nullptr) {
+            auto& count = hits[y * width_ + x];
+            count += count < max_hit_count ? 1 : 0;
+          }
+        }
+      }
+    };
+    workers.run(thread_count, work);
+    merge(thread_count, workers);
+  }
+
+  /** \brief Returns the number of marked pixels in each level. */
+  auto level_sizes() const -> const vector<std::size_t>& {
+    return level_sizes_;
+  }
+
+  /** \brief Returns the number of marked pixels. */
+  auto occupied_count() const -> std::size_t {
+    auto count = std::size_t{0};
+    for (const auto size : level_sizes_) {
+      count += size;
+    }
+    return count;
+  }
+
+  /** \brief Calls `callback(offset, pixel)` for every marked pixel.
+   *
+   *  Offsets run from zero to `occupied_count()`, each used once.
+   *  They order pixels by level, then by row, then by column,
+   *  so the caller can write results into a contiguous array
+   *  with every level in a contiguous range.
+   *  The callback is called concurrently from several threads.
+   */
+  template <typename callback_t>
+  void for_each_occupied(
+      callback_t&& callback, parallel::worker_pool& workers) const {
+    if (occupied_count() == 0) {
+      return;
+    }
+    const auto band_count = band_offsets_.size() / level_count_;
+    std::atomic<std::size_t> next_band{0};
+    auto work = [&](std::size_t /*worker*/) {
+      while (true) {
+        const auto band = next_band.fetch_add(1);
+        if (band >= band_count) {
+          return;
+        }
+        auto offsets = std::array<std::size_t, max_level_count>{};
+        std::copy_n(
+            band_offsets_.cbegin() + band * level_count_, level_count_,
+            offsets.begin());
+        const auto [row_begin, row_end] = rows_of(band);
+        for (auto row = row_begin; row < row_end; ++row) {
+          for (std::size_t word = 0; word < words_per_row_; ++word) {
+            auto remaining = bits_[row * words_per_row_ + word];
+            for (auto x = word * 64; remaining != 0;
+                 ++x, remaining >>= 1) {
+              if ((remaining & 1) == 0) {
+                continue;
+              }
+              const auto level = is_counting()
+                                     ? level_of(hits_[row * width_ + x])
+                                     : 0;
+              callback(
+                  offsets[level]++,
+                  pixel{static_cast<int>(x), static_cast<int>(row)});
+            }
+          }
+        }
+      }
+    };
+    workers.run(band_count, work);
+  }
+
+private:
+  static constexpr std::uint8_t max_hit_count =
+      std::numeric_limits<std::uint8_t>::max();
+
+  auto is_counting() const -> bool { return level_count_ > 1; }
+
+  auto contains(const pixel& target) const -> bool {
+    return 0 <= target[0] && target[0] < width_ && 0 <= target[1] &&
+           target[1] < height_;
+  }
+
+  auto rows_of(std::size_t band) const
+      -> std::array<std::size_t, 2> {
+    const auto row_begin = band * rows_per_band;
+    return {
+        row_begin, std::min(
+                       row_begin + rows_per_band,
+                       static_cast<std::size_t>(height_))};
+  }
+
+  auto level_of(std::uint8_t hit_count) const -> std::size_t {
+    auto level = std::size_t{0};
+    while (hit_count > 1 && level + 1 < level_count_) {
+      hit_count >>= 1;
+      ++level;
+    }
+    return level;
+  }
+
+  /** \brief Merges the marks of every worker into those of worker zero,
+   *         and computes where each band writes its pixels.
+   */
+  void merge(
+      std::size_t marked_worker_count, parallel::worker_pool& workers) {
+    const auto band_count = band_offsets_.size() / level_count_;
+    std::atomic<std::size_t> next_band{0};
+    auto work = [&](std::size_t /*worker*/) {
+      while (true) {
+        const auto band = next_band.fetch_add(1);
+        if (band >= band_count) {
+          return;
+        }
+        const auto [row_begin, row_end] = rows_of(band);
+        auto* const sizes = band_offsets_.data() + band * level_count_;
+        const auto word_begin = row_begin * words_per_row_;
+        const auto word_end = row_end * words_per_row_;
+        for (std::size_t worker = 1; worker < marked_worker_count;
+             ++worker) {
+          const auto* const bits =
+              bits_.data() + worker * words_per_worker_;
+          for (auto word = word_begin; word < word_end; ++word) {
+            bits_[word] |= bits[word];
+          }
+        }
+        if (!is_counting()) {
+          for (auto word = word_begin; word < word_end; ++word) {
+            sizes[0] += std::bitset<64>{bits_[word]}.count();
+          }
+          continue;
+        }
+        const auto pixel_begin = row_begin * width_;
+        const auto pixel_end = row_end * width_;
+        for (auto index = pixel_begin; index < pixel_end; ++index) {
+          auto count = unsigned{hits_[index]};
+          for (std::size_t worker = 1; worker < marked_worker_count;
+               ++worker) {
+            count += hits_[worker * pixels_per_worker_ + index];
+          }
+          if (count != 0) {
+            hits_[index] = static_cast<std::uint8_t>(
+                std::min<unsigned>(count, max_hit_count));
+            ++sizes[level_of(hits_[index])];
+          }
+        }
+      }
+    };
+    workers.run(band_count, work);
+
+    // Turns the sizes of each band into offsets,
+    // so that bands can be listed in parallel.
+    auto level_begin = std::size_t{0};
+    for (std::size_t level = 0; level < level_count_; ++level) {
+      auto offset = level_begin;
+      for (std::size_t band = 0; band < band_count; ++band) {
+        auto& size = band_offsets_[band * level_count_ + level];
+        const auto band_size = size;
+        size = offset;
+        offset += band_size;
+      }
+      level_sizes_[level] = offset - level_begin;
+      level_begin = offset;
+    }
+  }
+
+  int width_{};
+  int height_{};
+  std::size_t level_count_{1};
+  std::size_t words_per_row_{};
+  std::size_t words_per_worker_{};
+  std::size_t pixels_per_worker_{};
+  vector<std::uint64_t> bits_;
+  vector<std::uint8_t> hits_;
+  vector<std::size_t> band_offsets_;
+  vector<std::size_t> level_sizes_;
+};
+
+/** \brief A `basic_grid` using `std::allocator`. */
+using grid = basic_grid<>;
+
+} // namespace boni::pixel_occupancy
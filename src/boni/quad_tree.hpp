@@ -0,0 +1,412 @@
+#pragma once
+
+// Internal headers.
+#include "./worker_pool.hpp"
+
+// Standard library.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/** \brief Contains a point quad-tree and spatial queries on it. */
+namespace boni::quad_tree {
+
+/** \brief Coordinates of a point stored in a `tree`. */
+using point = std::array<int, 2>;
+
+/** \brief Axis-aligned box with inclusive bounds. */
+struct box {
+  point min{0, 0};
+  point max{0, 0};
+};
+
+/** \brief The box holding every point. */
+inline constexpr box everywhere{
+    {std::numeric_limits<int>::min(), std::numeric_limits<int>::min()},
+    {std::numeric_limits<int>::max(), std::numeric_limits<int>::max()}};
+
+namespace details {
+
+/** \brief Returns `x * x + y * y`,
+ *         or the largest `std::int64_t` if that does not fit.
+ *
+ *  Each of `x` and `y` is below `2^32`,
+ *  so their squares fit in `std::uint64_t`, but their sum may not.
+ */
+inline auto saturating_sum_of_squares(std::uint64_t x, std::uint64_t y)
+    -> std::int64_t {
+  constexpr auto max = std::numeric_limits<std::int64_t>::max();
+  constexpr auto unsigned_max = static_cast<std::uint64_t>(max);
+  const auto x_squared = x * x;
+  const auto y_squared = y * y;
+  if (x_squared > unsigned_max ||
+      y_squared > unsigned_max - x_squared) {
+    return max;
+  }
+  return static_cast<std::int64_t>(x_squared + y_squared);
+}
+
+/** \brief Returns the distance between two coordinates. */
+inline auto distance_between(int left, int right) -> std::uint64_t {
+  const auto delta = std::int64_t{left} - right;
+  return static_cast<std::uint64_t>(delta < 0 ? -delta : delta);
+}
+
+} // namespace details
+
+/** \brief Returns the squared Euclidean distance between two points.
+ *
+ *  Points at opposite ends of the `int` range are further apart
+ *  than `std::int64_t` can square,
+ *  so the result saturates at its largest value.
+ *  That still exceeds the square of any `int` radius.
+ */
+inline auto distance_squared(point left, point right) -> std::int64_t {
+  return details::saturating_sum_of_squares(
+      details::distance_between(left[0], right[0]),
+      details::distance_between(left[1], right[1]));
+}
+
+/** \brief Returns the squared distance between the closest points
+ *         of two boxes, or zero if they overlap.
+ *
+ *  Saturates like the distance between points.
+ */
+inline auto distance_squared(const box& left, const box& right)
+    -> std::int64_t {
+  const auto gap = [](int left_min, int left_max, int right_min,
+                      int right_max) -> std::uint64_t {
+    if (left_max < right_min) {
+      return details::distance_between(right_min, left_max);
+    }
+    if (right_max < left_min) {
+      return details::distance_between(left_min, right_max);
+    }
+    return 0;
+  };
+  return details::saturating_sum_of_squares(
+      gap(left.min[0], left.max[0], right.min[0], right.max[0]),
+      gap(left.min[1], left.max[1], right.min[1], right.max[1]));
+}
+
+/** \brief Point quad-tree rebuilt in bulk from a list of points.
+ *
+ *  Each node splits the tight bounding box of its points
+ *  into four quadrants about its centre.
+ *  Points are only stored in leaves.
+ *  They are copied into a single array, reordered so that
+ *  the points of every node form one contiguous range.
+ *  This keeps traversals cache friendly
+ *  and means a rebuild performs no per-node allocations
+ *  once the internal arrays have grown to size.
+ *
+ *  Queries report points by their index in the list given to `build`.
+ *
+ *  \tparam allocator_t
+ *          Allocator for the copied points,
+ *          rebound for the node, leaf and index arrays.
+ */
+template <typename allocator_t = std::allocator<point>>
+class basic_tree {
+  template <typename value_t>
+  using vector = std::vector<
+      value_t, typename std::allocator_traits<
+                   allocator_t>::template rebind_alloc<value_t>>;
+
+public:
+  /** \brief A node of the tree.
+   *
+   *  The children of a node, if any, are stored contiguously
+   *  in `nodes()`, starting from `first_child`.
+   *  Empty quadrants have no child node.
+   */
+  struct node {
+    /** \brief Tight bounds of all points under this node. */
+    box bounds;
+    /** \brief Start of the range of points in `points()`. */
+    std::size_t begin{};
+    /** \brief End of the range of points in `points()`. */
+    std::size_t end{};
+    /** \brief Index of the first child in `nodes()`. */
+    std::size_t first_child{};
+    /** \brief Number of children. Zero for a leaf. */
+    std::size_t child_count{};
+  };
+
+  /** \brief Number of points above which a leaf is split. */
+  static constexpr std::size_t default_leaf_capacity = 8;
+
+  basic_tree() = default;
+
+  /** \brief Sets the number of points above which a leaf is split. */
+  explicit basic_tree(std::size_t leaf_capacity)
+      : leaf_capacity_{std::max<std::size_t>(leaf_capacity, 1)} {}
+
+  /** \brief Replaces the content of the tree with the given points.
+   *
+   *  \param new_points
+   *         A contiguous container of `point`, such as `std::vector`.
+   */
+  template <typename points_t = std::vector<point>>
+  void build(const points_t& new_points) {
+    nodes_.clear();
+    leaves_.clear();
+    points_.assign(new_points.cbegin(), new_points.cend());
+    indices_.resize(new_points.size());
+    for (std::size_t index = 0; index < indices_.size(); ++index) {
+      indices_[index] = index;
+    }
+    if (points_.empty()) {
+      return;
+    }
+    nodes_.push_back(
+        node{bounds_of(0, points_.size()), 0, points_.size()});
+    split(0);
+  }
+
+  /** \brief Returns whether there are no points in the tree. */
+  auto empty() const -> bool { return points_.empty(); }
+
+  /** \brief Returns all nodes. The root, if any, is the first. */
+  auto nodes() const -> const vector<node>& { return nodes_; }
+
+  /** \brief Returns the index in `nodes()` of every leaf,
+   *         in increasing order of their point range.
+   */
+  auto leaves() const -> const vector<std::size_t>& {
+    return leaves_;
+  }
+
+  /** \brief Returns the stored points, in tree order. */
+  auto points() const -> const vector<point>& { return points_; }
+
+  /** \brief Maps from tree order to the index given to `build`. */
+  auto indices() const -> const vector<std::size_t>& {
+    return indices_;
+  }
+
+private:
+  auto bounds_of(std::size_t begin, std::size_t end) const -> box {
+    auto bounds = box{points_[begin], points_[begin]};
+    for (auto index = begin + 1; index < end; ++index) {
+      const auto& position = points_[index];
+      for (std::size_t axis = 0; axis < 2; ++axis) {
+        bounds.min[axis] = std::min(bounds.min[axis], position[axis]);
+        bounds.max[axis] = std::max(bounds.max[axis], position[axis]);
+      }
+    }
+    return bounds;
+  }
+
+  /** \brief Returns the floor of the mean of the given coordinates.
+   *
+   *  Rounding down, rather than towards zero, ensures that
+   *  `low <= middle < high` whenever `low < high`,
+   *  so that splitting about it always separates some points.
+   */
+  static auto middle_of(int low, int high) -> std::int64_t {
+    const auto sum = std::int64_t{low} + high;
+    return sum >= 0 ? sum / 2 : -((-sum + 1) / 2);
+  }
+
+  /** \brief Moves points at or below `middle` in `axis` to the front.
+   *
+   *  Returns the end of the moved range.
+   */
+  auto partition(
+      std::size_t begin, std::size_t end, std::size_t axis,
+      std::int64_t middle) -> std::size_t {
+    auto boundary = begin;
+    for (auto index = begin; index < end; ++index) {
+      if (points_[index][axis] <= middle) {
+        std::swap(points_[index], points_[boundary]);
+        std::swap(indices_[index], indices_[boundary]);
+        ++boundary;
+      }
+    }
+    return boundary;
+  }
+
+  void split(std::size_t node_index) {
+    const auto current = nodes_[node_index];
+    const auto& bounds = current.bounds;
+    const auto is_degenerate =
+        bounds.min[0] == bounds.max[0] && bounds.min[1] == bounds.max[1];
+    if (current.end - current.begin <= leaf_capacity_ || is_degenerate) {
+      leaves_.push_back(node_index);
+      return;
+    }
+
+    const auto middle_x = middle_of(bounds.min[0], bounds.max[0]);
+    const auto middle_y = middle_of(bounds.min[1], bounds.max[1]);
+    const auto split_x =
+        partition(current.begin, current.end, 0, middle_x);
+    const auto split_low_y =
+        partition(current.begin, split_x, 1, middle_y);
+    const auto split_high_y =
+        partition(split_x, current.end, 1, middle_y);
+    const std::array<std::size_t, 5> boundaries{
+        current.begin, split_low_y, split_x, split_high_y, current.end};
+
+    const auto first_child = nodes_.size();
+    for (std::size_t quadrant = 0; quadrant < 4; ++quadrant) {
+      const auto begin = boundaries[quadrant];
+      const auto end = boundaries[quadrant + 1];
+      if (begin != end) {
+        nodes_.push_back(node{bounds_of(begin, end), begin, end});
+      }
+    }
+    const auto child_count = nodes_.size() - first_child;
+    nodes_[node_index].first_child = first_child;
+    nodes_[node_index].child_count = child_count;
+    for (auto child = first_child; child < first_child + child_count;
+         ++child) {
+      split(child);
+    }
+  }
+
+  std::size_t leaf_capacity_{default_leaf_capacity};
+  vector<node> nodes_;
+  vector<std::size_t> leaves_;
+  vector<point> points_;
+  vector<std::size_t> indices_;
+};
+
+/** \brief A `basic_tree` using `std::allocator`. */
+using tree = basic_tree<>;
+
+namespace details {
+
+/** \brief Reports pairs between `leaf` and the leaves under `other`
+ *         that are not before `leaf`.
+ *
+ *  Subtrees too far from `leaf`, or whose points all precede it,
+ *  are pruned without visiting their points.
+ */
+template <typename tree_t, typename callback_t>
+void for_each_pair_from_leaf(
+    const tree_t& index, const typename tree_t::node& leaf,
+    std::size_t other_index,
+    std::int64_t radius_squared, std::size_t worker,
+    callback_t& callback) {
+  const auto& other = index.nodes()[other_index];
+  if (other.end <= leaf.begin) {
+    return;
+  }
+  if (distance_squared(leaf.bounds, other.bounds) > radius_squared) {
+    return;
+  }
+  if (other.child_count > 0) {
+    const auto children_end = other.first_child + other.child_count;
+    for (auto child = other.first_child; child < children_end; ++child) {
+      for_each_pair_from_leaf(
+          index, leaf, child, radius_squared, worker, callback);
+    }
+    return;
+  }
+
+  const auto& points = index.points();
+  const auto& indices = index.indices();
+  const auto is_same_leaf = other.begin == leaf.begin;
+  for (auto first = leaf.begin; first < leaf.end; ++first) {
+    const auto first_point = points[first];
+    const auto second_begin = is_same_leaf ? first + 1 : other.begin;
+    for (auto second = second_begin; second < other.end; ++second) {
+      if (distance_squared(first_point, points[second]) <=
+          radius_squared) {
+        callback(worker, indices[first], indices[second]);
+      }
+    }
+  }
+}
+
+} // namespace details
+
+/** \brief Calls `callback` for every pair of points
+ *         at most `radius` apart.
+ *
+ *  \param index
+ *         The `basic_tree` holding the points.
+ *  \param radius
+ *         Largest Euclidean distance of a reported pair.
+ *  \param callback
+ *         Called as `callback(worker, first, second)`,
+ *         where `first` and `second` are indices into the list
+ *         given to `basic_tree::build`,
+ *         and `worker` is below `workers.worker_count()`.
+ *  \param workers
+ *         The threads to split the work across.
+ *  \param region
+ *         Leaves further than `radius` from it are not searched from.
+ *         Every pair whose connecting segment meets the region
+ *         is still reported, since both of its points lie within
+ *         `radius` of the region, but others may be skipped.
+ *
+ *  Each unordered pair is reported at most once,
+ *  in no particular order.
+ *  Pairs are streamed to `callback` as they are found
+ *  rather than collected, so the number of pairs is not bounded
+ *  by available memory.
+ *
+ *  The callback is invoked concurrently from different threads,
+ *  but never concurrently for the same `worker`.
+ *  It can therefore accumulate into per-worker storage
+ *  without locking.
+ *  It must not throw.
+ */
+template <typename tree_t, typename callback_t>
+void for_each_pair_within(
+    const tree_t& index, int radius, callback_t&& callback,
+    parallel::worker_pool& workers, const box& region = everywhere) {
+  if (index.empty() || radius < 0) {
+    return;
+  }
+  const auto radius_squared = std::int64_t{radius} * radius;
+  const auto& leaves = index.leaves();
+
+  // Leaves are handed out in small chunks so that threads that drew
+  // sparse regions pick up more work instead of idling.
+  constexpr std::size_t chunk_size = 16;
+  std::atomic<std::size_t> next_leaf{0};
+  const auto work = [&](std::size_t worker) {
+    while (true) {
+      const auto chunk_begin = next_leaf.fetch_add(chunk_size);
+      if (chunk_begin >= leaves.size()) {
+        return;
+      }
+      const auto chunk_end =
+          std::min(chunk_begin + chunk_size, leaves.size());
+      for (auto leaf = chunk_begin; leaf < chunk_end; ++leaf) {
+        const auto& leaf_node = index.nodes()[leaves[leaf]];
+        if (distance_squared(leaf_node.bounds, region) >
+            radius_squared) {
+          continue;
+        }
+        details::for_each_pair_from_leaf(
+            index, leaf_node, 0, radius_squared, worker, callback);
+      }
+    }
+  };
+
+  workers.run((leaves.size() + chunk_size - 1) / chunk_size, work);
+}
+
+/** \brief Like the overload taking a `parallel::worker_pool`,
+ *         but starts and joins `worker_count - 1` threads for this
+ *         call alone.
+ */
+template <typename tree_t, typename callback_t>
+void for_each_pair_within(
+    const tree_t& index, int radius, callback_t&& callback,
+    unsigned worker_count = std::thread::hardware_concurrency()) {
+  auto workers = parallel::worker_pool{worker_count};
+  for_each_pair_within(index, radius, callback, workers);
+}
+
+} // namespace boni::quad_tree
@@ -0,0 +1,135 @@
+#pragma once
+
+// Standard library.
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/** \brief Contains utilities for running work on several threads. */
+namespace boni::parallel {
+
+/** \brief Threads started once and reused for every parallel loop.
+ *
+ *  Starting a thread heap-allocates its state
+ *  and takes tens of microseconds,
+ *  which adds up for loops run several times a frame.
+ *  The threads of a pool instead park on a condition variable
+ *  between runs, so running work does not allocate.
+ */
+class worker_pool {
+public:
+  /** \brief Starts `worker_count - 1` threads.
+   *
+   *  The thread calling `run` is the remaining worker.
+   */
+  explicit worker_pool(
+      unsigned worker_count = std::thread::hardware_concurrency())
+      : worker_count_{std::max(worker_count, 1U)} {
+    threads_.reserve(worker_count_ - 1);
+    for (std::size_t worker = 1; worker < worker_count_; ++worker) {
+      threads_.emplace_back(&worker_pool::run_thread, this, worker);
+    }
+  }
+
+  /** \brief Stops and joins the threads. */
+  ~worker_pool() {
+    {
+      const std::lock_guard<std::mutex> lock{mutex_};
+      is_stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  worker_pool(const worker_pool&) = delete;
+  auto operator=(const worker_pool&) -> worker_pool& = delete;
+
+  /** \brief Returns the number of workers, including the caller. */
+  auto worker_count() const -> unsigned { return worker_count_; }
+
+  /** \brief Calls `work(worker)` for every worker below `thread_count`
+   *         and waits for all of them.
+   *
+   *  `thread_count` is capped at `worker_count()`.
+   *  Worker zero runs on the calling thread,
+   *  so a single worker involves no other thread.
+   *  Runs from different threads take turns.
+   *  `work` must not throw.
+   */
+  template <typename work_t>
+  void run(std::size_t thread_count, work_t&& work) {
+    thread_count =
+        std::clamp<std::size_t>(thread_count, 1, worker_count_);
+    if (thread_count == 1) {
+      work(std::size_t{0});
+      return;
+    }
+    using function_t = std::remove_reference_t<work_t>;
+    const std::lock_guard<std::mutex> run_lock{run_mutex_};
+    {
+      const std::lock_guard<std::mutex> lock{mutex_};
+      context_ = const_cast<void*>(
+          static_cast<const void*>(std::addressof(work)));
+      call_ = [](void* context, std::size_t worker) {
+        (*static_cast<function_t*>(context))(worker);
+      };
+      thread_count_ = thread_count;
+      pending_count_ = thread_count - 1;
+      ++generation_;
+    }
+    wake_.notify_all();
+    work(std::size_t{0});
+    std::unique_lock<std::mutex> lock{mutex_};
+    done_.wait(lock, [this] { return pending_count_ == 0; });
+  }
+
+private:
+  void run_thread(std::size_t worker) {
+    auto seen_generation = std::size_t{0};
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (true) {
+      wake_.wait(lock, [&] {
+        return is_stopping_ || generation_ != seen_generation;
+      });
+      if (is_stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+      if (worker >= thread_count_) {
+        continue;
+      }
+      auto* const call = call_;
+      auto* const context = context_;
+      lock.unlock();
+      call(context, worker);
+      lock.lock();
+      if (--pending_count_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+
+  unsigned worker_count_;
+  std::vector<std::thread> threads_;
+  // Held for a whole run, so that runs take turns.
+  std::mutex run_mutex_;
+  // Guards every member below.
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  void (*call_)(void*, std::size_t){};
+  void* context_{};
+  std::size_t thread_count_{};
+  std::size_t pending_count_{};
+  std::size_t generation_{};
+  bool is_stopping_{};
+};
+
+} // namespace boni::parallel
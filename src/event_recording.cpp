@@ -0,0 +1,208 @@
+// Corresponding headers.
+#include "event_recording.hpp"
+
+// Standard libraries.
+#include <array>
+
+// C Standard libraries.
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+constexpr std::array<char, 4> RECORDING_MAGIC{'Q', 'W', 'E', 'V'};
+constexpr std::uint8_t RECORDING_VERSION{1};
+
+auto write_bytes(std::FILE* file, const void* data, std::size_t size)
+    -> bool {
+  return std::fwrite(data, 1, size, file) == size;
+}
+
+auto read_bytes(std::FILE* file, void* data, std::size_t size) -> bool {
+  return std::fread(data, 1, size, file) == size;
+}
+
+auto write_u8(std::FILE* file, std::uint8_t value) -> bool {
+  return write_bytes(file, &value, 1);
+}
+
+auto read_u8(std::FILE* file, std::uint8_t& value) -> bool {
+  return read_bytes(file, &value, 1);
+}
+
+auto write_u32(std::FILE* file, std::uint32_t value) -> bool {
+  const std::array<std::uint8_t, 4> bytes{
+      static_cast<std::uint8_t>(value),
+      static_cast<std::uint8_t>(value >> 8),
+      static_cast<std::uint8_t>(value >> 16),
+      static_cast<std::uint8_t>(value >> 24)};
+  return write_bytes(file, bytes.data(), bytes.size());
+}
+
+auto read_u32(std::FILE* file, std::uint32_t& value) -> bool {
+  std::array<std::uint8_t, 4> bytes{};
+  if (!read_bytes(file, bytes.data(), bytes.size())) {
+    return false;
+  }
+  value = std::uint32_t{bytes[0]} | std::uint32_t{bytes[1]} << 8 |
+          std::uint32_t{bytes[2]} << 16 | std::uint32_t{bytes[3]} << 24;
+  return true;
+}
+
+auto write_i32(std::FILE* file, std::int32_t value) -> bool {
+  return write_u32(file, static_cast<std::uint32_t>(value));
+}
+
+auto read_i32(std::FILE* file, std::int32_t& value) -> bool {
+  auto unsigned_value = std::uint32_t{};
+  if (!read_u32(file, unsigned_value)) {
+    return false;
+  }
+  value = static_cast<std::int32_t>(unsigned_value);
+  return true;
+}
+
+} // namespace
+
+auto to_recorded_event(const SDL_Event& event)
+    -> std::optional<RecordedEvent> {
+  switch (event.type) {
+  case SDL_MOUSEBUTTONDOWN:
+  case SDL_MOUSEBUTTONUP: {
+    const auto& button_event = event.button;
+    return RecordedEvent{
+        event.type == SDL_MOUSEBUTTONDOWN
+            ? RecordedEventType::mouse_button_down
+            : RecordedEventType::mouse_button_up,
+        button_event.timestamp, button_event.button, button_event.x,
+        button_event.y};
+  }
+  case SDL_MOUSEMOTION: {
+    const auto& motion_event = event.motion;
+    return RecordedEvent{
+        RecordedEventType::mouse_motion, motion_event.timestamp, 0,
+        motion_event.x, motion_event.y};
+  }
+  case SDL_MOUSEWHEEL: {
+    const auto& wheel_event = event.wheel;
+    return RecordedEvent{
+        RecordedEventType::mouse_wheel, wheel_event.timestamp, 0,
+        wheel_event.x, wheel_event.y};
+  }
+  default:
+    return std::nullopt;
+  }
+}
+
+auto to_sdl_event(const RecordedEvent& recorded_event, Uint32 window_id)
+    -> SDL_Event {
+  SDL_Event event;
+  std::memset(&event, 0, sizeof(event));
+  switch (recorded_event.type) {
+  case RecordedEventType::mouse_button_down:
+  case RecordedEventType::mouse_button_up: {
+    const auto is_down =
+        recorded_event.type == RecordedEventType::mouse_button_down;
+    auto& button_event = event.button;
+    button_event.type =
+        is_down ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+    button_event.timestamp = recorded_event.timestamp;
+    button_event.windowID = window_id;
+    button_event.button = recorded_event.button;
+    button_event.state = is_down ? SDL_PRESSED : SDL_RELEASED;
+    button_event.clicks = 1;
+    button_event.x = recorded_event.x;
+    button_event.y = recorded_event.y;
+  } break;
+  case RecordedEventType::mouse_motion: {
+    auto& motion_event = event.motion;
+    motion_event.type = SDL_MOUSEMOTION;
+    motion_event.timestamp = recorded_event.timestamp;
+    motion_event.windowID = window_id;
+    motion_event.x = recorded_event.x;
+    motion_event.y = recorded_event.y;
+  } break;
+  case RecordedEventType::mouse_wheel: {
+    auto& wheel_event = event.wheel;
+    wheel_event.type = SDL_MOUSEWHEEL;
+    wheel_event.timestamp = recorded_event.timestamp;
+    wheel_event.windowID = window_id;
+    wheel_event.x = recorded_event.x;
+    wheel_event.y = recorded_event.y;
+    wheel_event.preciseX = static_cast<float>(recorded_event.x);
+    wheel_event.preciseY = static_cast<float>(recorded_event.y);
+  } break;
+  case RecordedEventType::frame_end:
+    break;
+  }
+  return event;
+}
+
+auto write_recording_header(std::FILE* file) -> bool {
+  return write_bytes(
+             file, RECORDING_MAGIC.data(), RECORDING_MAGIC.size()) &&
+         write_u8(file, RECORDING_VERSION);
+}
+
+auto read_recording_header(std::FILE* file) -> bool {
+  auto magic = std::array<char, 4>{};
+  auto version = std::uint8_t{};
+  return read_bytes(file, magic.data(), magic.size()) &&
+         magic == RECORDING_MAGIC && read_u8(file, version) &&
+         version == RECORDING_VERSION;
+}
+
+auto write_recorded_event(
+    std::FILE* file, const RecordedEvent& recorded_event) -> bool {
+  if (!write_u8(file, static_cast<std::uint8_t>(recorded_event.type)) ||
+      !write_u32(file, recorded_event.timestamp)) {
+    return false;
+  }
+  switch (recorded_event.type) {
+  case RecordedEventType::frame_end:
+    return true;
+  case RecordedEventType::mouse_button_down:
+  case RecordedEventType::mouse_button_up:
+    if (!write_u8(file, recorded_event.button)) {
+      return false;
+    }
+    [[fallthrough]];
+  case RecordedEventType::mouse_motion:
+  case RecordedEventType::mouse_wheel:
+    return write_i32(file, recorded_event.x) &&
+           write_i32(file, recorded_event.y);
+  }
+  return false;
+}
+
+auto read_recorded_event(std::FILE* file, RecordedEvent& recorded_event)
+    -> RecordReadStatus {
+  auto type = std::uint8_t{};
+  if (!read_u8(file, type)) {
+    return std::ferror(file) != 0 ? RecordReadStatus::malformed
+                                  : RecordReadStatus::end_of_file;
+  }
+  recorded_event = RecordedEvent{};
+  if (!read_u32(file, recorded_event.timestamp)) {
+    return RecordReadStatus::malformed;
+  }
+  recorded_event.type = static_cast<RecordedEventType>(type);
+  switch (recorded_event.type) {
+  case RecordedEventType::frame_end:
+    return RecordReadStatus::event;
+  case RecordedEventType::mouse_button_down:
+  case RecordedEventType::mouse_button_up:
+    if (!read_u8(file, recorded_event.button)) {
+      return RecordReadStatus::malformed;
+    }
+    [[fallthrough]];
+  case RecordedEventType::mouse_motion:
+  case RecordedEventType::mouse_wheel:
+    if (!read_i32(file, recorded_event.x) ||
+        !read_i32(file, recorded_event.y)) {
+      return RecordReadStatus::malformed;
+    }
+    return RecordReadStatus::event;
+  }
+  return RecordReadStatus::malformed;
+}
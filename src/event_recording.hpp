@@ -0,0 +1,83 @@
+#pragma once
+
+// Internal headers.
+#include "boni/memory.hpp"
+
+// External dependencies.
+#include <SDL.h>
+
+// Standard libraries.
+#include <optional>
+
+// C Standard libraries.
+#include <cstdint>
+#include <cstdio>
+
+// Recording of handled input events, for replaying a session
+// without a window to reproduce its performance.
+//
+// A recording is a short header followed by variable-length records,
+// with all integers stored little-endian.
+// Each record starts with its `RecordedEventType`
+// and the timestamp of the event in milliseconds.
+// Button records then store the button and the mouse position,
+// and motion and wheel records store a position or scroll amount.
+// A `frame_end` record marks the end of a batch of events
+// that was handled before rendering a frame,
+// so that a replay renders the same sequence of frames.
+
+using File = boni::memory::handle<std::FILE*, int, std::fclose>;
+
+enum class RecordedEventType : std::uint8_t {
+  frame_end = 0,
+  mouse_button_down = 1,
+  mouse_button_up = 2,
+  mouse_motion = 3,
+  mouse_wheel = 4,
+};
+
+/** \brief Outcome of reading a record. */
+enum class RecordReadStatus {
+  event,
+  // The file ended between records.
+  end_of_file,
+  // The record was cut short, of an unknown type, or unreadable.
+  malformed,
+};
+
+struct RecordedEvent {
+  RecordedEventType type{RecordedEventType::frame_end};
+  std::uint32_t timestamp{};
+  std::uint8_t button{};
+  std::int32_t x{};
+  std::int32_t y{};
+};
+
+/** \brief Returns the record of the given event,
+ *         or nothing if its type is not recorded.
+ */
+auto to_recorded_event(const SDL_Event& event)
+    -> std::optional<RecordedEvent>;
+
+/** \brief Returns the event to replay for the given record.
+ *
+ *  Must not be called with a `frame_end` record.
+ */
+auto to_sdl_event(const RecordedEvent& recorded_event, Uint32 window_id)
+    -> SDL_Event;
+
+auto write_recording_header(std::FILE* file) -> bool;
+
+/** \brief Returns whether the file starts with a supported header. */
+auto read_recording_header(std::FILE* file) -> bool;
+
+auto write_recorded_event(
+    std::FILE* file, const RecordedEvent& recorded_event) -> bool;
+
+/** \brief Reads the next record into `recorded_event`.
+ *
+ *  Tells a clean end of the file apart from a malformed record,
+ *  so that a replay does not pass off a damaged recording as whole.
+ */
+auto read_recorded_event(std::FILE* file, RecordedEvent& recorded_event)
+    -> RecordReadStatus;
@@ -1,6 +1,10 @@
 // Internal headers.
 #include "boni/ImGui.hpp"
 #include "boni/SDL2.hpp"
+#include "event_recording.hpp"
+#include "memory_accounting.hpp"
+#include "render_pipeline.hpp"
+#include "render_state.hpp"
 
 // External dependencies.
 #include <boost/numeric/conversion/cast.hpp>
@@ -14,6 +18,7 @@
 // Standard libraries.
 #include <algorithm>
 #include <array>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <optional>
@@ -24,84 +29,75 @@
 
 // C Standard libraries.
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 
-constexpr auto ZOOM_PER_LEVEL{0.9f};
-
-using Position = std::array<int, 2>;
-
-struct Drag {
-  SDL_Point start_mouse_point{0, 0};
-  Position start_position{0, 0};
-};
-
-struct Camera {
-  Position position;
-  int zoom_level{};
-  std::optional<Drag> drag;
-};
-
-auto get_zoom(const Camera& camera) {
-  return std::pow(ZOOM_PER_LEVEL, camera.zoom_level);
-}
-
-auto viewport_to_world(
-    const Camera& camera, const SDL_Point viewport_point) -> Position {
-  const auto zoom = get_zoom(camera);
-  const auto world_point_relative_to_camera_x =
-      static_cast<float>(viewport_point.x) / zoom;
-  const auto world_point_relative_to_camera_y =
-      static_cast<float>(viewport_point.y) / zoom;
-  const auto camera_position = camera.position;
-  return {
-      boost::numeric_cast<int>(world_point_relative_to_camera_x) +
-          camera_position[0],
-      boost::numeric_cast<int>(world_point_relative_to_camera_y) +
-          camera_position[1]};
+auto allocate_imgui_memory(std::size_t byte_count, void* /*user_data*/)
+    -> void* {
+  return boni::allocation::malloc_counted(
+      boni::allocation::counter_of<ImGuiMemory>, byte_count);
 }
 
-auto world_to_viewport(const Camera& camera, const Position world_point)
-    -> SDL_Point {
-  const auto camera_position = camera.position;
-  const auto world_point_relative_to_camera_x =
-      static_cast<float>(world_point[0] - camera_position[0]);
-  const auto world_point_relative_to_camera_y =
-      static_cast<float>(world_point[1] - camera_position[1]);
-  const auto zoom = get_zoom(camera);
-  return {
-      boost::numeric_cast<int>(world_point_relative_to_camera_x * zoom),
-      boost::numeric_cast<int>(world_point_relative_to_camera_y * zoom)
-
-  };
+void free_imgui_memory(void* pointer, void* /*user_data*/) {
+  boni::allocation::free_counted(
+      boni::allocation::counter_of<ImGuiMemory>, pointer);
 }
 
-struct RenderState {
-  std::vector<Position> positions;
-  std::vector<SDL_Point> draw_points;
-  Camera camera;
-};
-
-void refresh_positions_render_cache(RenderState& state) {
-  const auto& positions = state.positions;
-  const auto& camera = state.camera;
-  auto& draw_positions = state.draw_points;
-  draw_positions.clear();
-  std::transform(
-      positions.cbegin(), positions.cend(),
-      std::back_inserter(draw_positions),
-      [&camera](Position point) -> SDL_Point {
-        return world_to_viewport(camera, point);
-      });
+void process_memory_gui() {
+  const auto is_shown = ImGui::Begin("Memory");
+  struct WindowCleanup {
+    ~WindowCleanup() { ImGui::End(); }
+  } _window_cleanup;
+  if (!is_shown) {
+    return;
+  }
+  if (ImGui::Button("Reset peaks")) {
+    reset_memory_peaks();
+  }
+  constexpr auto column_count = 4;
+  if (ImGui::BeginTable("MemoryTable", column_count)) {
+    struct TableCleanup {
+      ~TableCleanup() { ImGui::EndTable(); }
+    } _table_cleanup;
+    ImGui::TableSetupColumn("Subsystem");
+    ImGui::TableSetupColumn("Live bytes");
+    ImGui::TableSetupColumn("Peak bytes");
+    ImGui::TableSetupColumn("Allocations");
+    ImGui::TableHeadersRow();
+    for (const auto& subsystem : get_memory_statistics()) {
+      const auto& values = subsystem.values;
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(subsystem.name);
+      ImGui::TableNextColumn();
+      ImGui::Text("%zu", values.live_bytes);
+      ImGui::TableNextColumn();
+      ImGui::Text("%zu", values.peak_bytes);
+      ImGui::TableNextColumn();
+      ImGui::Text("%zu", values.allocation_count);
+    }
+  }
 }
 
-void process_gui(RenderState& state) {
+// Returns whether the world was changed through the GUI.
+auto process_gui(RenderState& state) -> bool {
+  auto is_changed = false;
   const auto is_shown = ImGui::Begin("Positions");
   struct WindowCleanup {
     ~WindowCleanup() { ImGui::End(); }
   } _window_cleanup;
   // const boni::cleanup<ImGui::End> _window_cleanup{};
   if (is_shown) {
+    is_changed |= ImGui::Checkbox(
+        "Show neighbour lines", &state.is_neighbour_lines_shown);
+    if (ImGui::InputInt("Neighbour radius", &state.neighbour_radius)) {
+      state.neighbour_radius = std::max(state.neighbour_radius, 0);
+      is_changed = true;
+    }
+    is_changed |= ImGui::Checkbox(
+        "Brighter where points overlap",
+        &state.is_point_intensity_shown);
     constexpr auto dimension = 2;
     const auto is_shown = ImGui::BeginTable("PositionTable", dimension);
     if (is_shown) {
@@ -118,44 +114,426 @@ void process_gui(RenderState& state) {
         } _id_cleanup;
         // const boni::cleanup<ImGui::PopID> _id_cleanup{};
         ImGui::TableNextColumn();
-        ImGui::InputInt2("", positions[row].data());
+        if (ImGui::InputInt2("", positions[row].data())) {
+          ++state.position_revision;
+          is_changed = true;
+        }
       }
       ImGui::TableNextRow();
       ImGui::TableNextColumn();
       const auto is_clicked = ImGui::Button("+##AddRow");
       if (is_clicked) {
         positions.push_back({0, 0});
+        ++state.position_revision;
+        is_changed = true;
       }
     }
   }
+  return is_changed;
 }
 
-auto render(boni::SDL2::renderer& renderer, RenderState& state) -> int {
+// Edits the shapes of the world.
+// Returns whether they were changed.
+auto process_shapes_gui(RenderState& state) -> bool {
+  auto is_changed = false;
+  const auto is_shown = ImGui::Begin("Shapes");
+  struct WindowCleanup {
+    ~WindowCleanup() { ImGui::End(); }
+  } _window_cleanup;
+  if (!is_shown) {
+    return is_changed;
+  }
+  constexpr auto column_count = 2;
+  if (ImGui::BeginTable("RectangleTable", column_count)) {
+    struct TableCleanup {
+      ~TableCleanup() { ImGui::EndTable(); }
+    } _table_cleanup;
+    ImGui::TableSetupColumn("Rectangle min");
+    ImGui::TableSetupColumn("Rectangle max");
+    ImGui::TableHeadersRow();
+    auto& rectangles = state.rectangles;
+    for (std::size_t row = 0; row < rectangles.size(); ++row) {
+      ImGui::TableNextRow();
+      ImGui::PushID(static_cast<int>(row));
+      struct IdCleanup {
+        ~IdCleanup() { ImGui::PopID(); }
+      } _id_cleanup;
+      auto& rectangle = rectangles[row];
+      ImGui::TableNextColumn();
+      is_changed |= ImGui::InputInt2("##Min", rectangle.min.data());
+      ImGui::TableNextColumn();
+      is_changed |= ImGui::InputInt2("##Max", rectangle.max.data());
+      for (std::size_t axis = 0; axis < 2; ++axis) {
+        rectangle.max[axis] =
+            std::max(rectangle.max[axis], rectangle.min[axis]);
+      }
+    }
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    if (ImGui::Button("+##AddRectangle")) {
+      rectangles.push_back({{0, 0}, {64, 64}});
+      is_changed = true;
+    }
+  }
+  if (ImGui::BeginTable("SegmentTable", column_count)) {
+    struct TableCleanup {
+      ~TableCleanup() { ImGui::EndTable(); }
+    } _table_cleanup;
+    ImGui::TableSetupColumn("Segment start");
+    ImGui::TableSetupColumn("Segment end");
+    ImGui::TableHeadersRow();
+    auto& segments = state.segments;
+    for (std::size_t row = 0; row < segments.size(); ++row) {
+      ImGui::TableNextRow();
+      ImGui::PushID(static_cast<int>(row));
+      struct IdCleanup {
+        ~IdCleanup() { ImGui::PopID(); }
+      } _id_cleanup;
+      auto& segment = segments[row];
+      ImGui::TableNextColumn();
+      is_changed |= ImGui::InputInt2("##Start", segment.start.data());
+      ImGui::TableNextColumn();
+      is_changed |= ImGui::InputInt2("##End", segment.end.data());
+    }
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    if (ImGui::Button("+##AddSegment")) {
+      // Continues from the last segment, to build up paths.
+      const auto start =
+          segments.empty() ? Position{0, 0} : segments.back().end;
+      segments.push_back({start, {start[0] + 64, start[1]}});
+      is_changed = true;
+    }
+  }
+  return is_changed;
+}
+
+auto render(boni::SDL2::renderer& renderer, const RenderState& state)
+    -> int {
   if (SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0) != 0) {
     return -1;
   }
   if (SDL_RenderClear(renderer) != 0) {
     return -1;
   }
-  refresh_positions_render_cache(state);
-  auto& draw_points = state.draw_points;
-  auto draw_count = boost::numeric_cast<int>(draw_points.size());
-  if (draw_count > 0) {
-    constexpr auto max_value = std::numeric_limits<std::uint8_t>::max();
+  constexpr auto max_value = std::numeric_limits<std::uint8_t>::max();
+  const auto& line_points = state.neighbour_line_points;
+  if (!line_points.empty()) {
+    constexpr auto line_value = max_value / 2;
     if (SDL_SetRenderDrawColor(
-            renderer, max_value, max_value, max_value, max_value) != 0) {
+            renderer, line_value, line_value, line_value, max_value) !=
+        0) {
       return -1;
     }
-    if (SDL_RenderDrawPoints(renderer, draw_points.data(), draw_count) !=
-        0) {
+    for (std::size_t index = 0; index < line_points.size(); index += 2) {
+      const auto start = line_points[index];
+      const auto end = line_points[index + 1];
+      if (SDL_RenderDrawLine(renderer, start.x, start.y, end.x, end.y) !=
+          0) {
+        return -1;
+      }
+    }
+  }
+
+  const auto& draw_rectangles = state.draw_rectangles;
+  if (!draw_rectangles.empty()) {
+    constexpr auto fill_value = max_value / 4;
+    constexpr auto fill_blue_value = max_value / 2;
+    if (SDL_SetRenderDrawColor(
+            renderer, fill_value, fill_value, fill_blue_value,
+            max_value) != 0) {
+      return -1;
+    }
+    if (SDL_RenderFillRects(
+            renderer, draw_rectangles.data(),
+            boost::numeric_cast<int>(draw_rectangles.size())) != 0) {
+      return -1;
+    }
+  }
+
+  const auto& polyline_sizes = state.segment_polyline_sizes;
+  if (!polyline_sizes.empty()) {
+    if (SDL_SetRenderDrawColor(
+            renderer, max_value, max_value / 2, 0, max_value) != 0) {
       return -1;
     }
+    const auto* polyline_points = state.segment_polyline_points.data();
+    for (const auto polyline_size : polyline_sizes) {
+      if (SDL_RenderDrawLines(
+              renderer, polyline_points, polyline_size) != 0) {
+        return -1;
+      }
+      polyline_points += polyline_size;
+    }
+  }
+
+  // One call per intensity level, dimmest first.
+  const auto& level_sizes = state.point_occupancy.level_sizes();
+  const auto level_count = level_sizes.size();
+  const auto* level_points = state.draw_points.data();
+  for (std::size_t level = 0; level < level_count; ++level) {
+    const auto draw_count =
+        boost::numeric_cast<int>(level_sizes[level]);
+    if (draw_count == 0) {
+      continue;
+    }
+    const auto value = boost::numeric_cast<std::uint8_t>(
+        max_value * (level + 1) / level_count);
+    if (SDL_SetRenderDrawColor(
+            renderer, value, value, value, max_value) != 0) {
+      return -1;
+    }
+    if (SDL_RenderDrawPoints(renderer, level_points, draw_count) != 0) {
+      return -1;
+    }
+    level_points += draw_count;
+  }
+
+  return 0;
+}
+
+struct EventResult {
+  bool is_processed{};
+  bool is_redraw_needed{};
+  bool is_quit{};
+};
+
+auto process_event(
+    RenderState& render_state, const SDL_Event& event,
+    const ImGuiIO& io, Uint32 window_id) -> EventResult {
+  auto result = EventResult{};
+  switch (event.type) {
+  case SDL_MOUSEBUTTONDOWN:
+    if (!io.WantCaptureMouse) {
+      const auto& button_event = event.button;
+      switch (button_event.button) {
+      case SDL_BUTTON_LEFT: {
+        const auto new_point = viewport_to_world(
+            render_state.camera, {button_event.x, button_event.y});
+        render_state.positions.push_back(new_point);
+        ++render_state.position_revision;
+        result.is_processed = true;
+        result.is_redraw_needed = true;
+      } break;
+      case SDL_BUTTON_RIGHT: {
+        auto& camera = render_state.camera;
+        camera.drag.emplace(
+            Drag{{button_event.x, button_event.y}, camera.position});
+        result.is_processed = true;
+      } break;
+      default:
+        break;
+      }
+    }
+    break;
+  case SDL_MOUSEBUTTONUP: {
+    auto& drag = render_state.camera.drag;
+    const auto& button_event = event.button;
+    if (drag.has_value() && button_event.button == SDL_BUTTON_RIGHT) {
+      drag.reset();
+      result.is_processed = true;
+    }
+  } break;
+  case SDL_MOUSEMOTION: {
+    auto& camera = render_state.camera;
+    auto& drag_maybe = camera.drag;
+    if (drag_maybe.has_value()) {
+      auto& drag = camera.drag.value();
+      camera.position = drag.start_position;
+      const auto& motion_event = event.motion;
+      const auto start_mouse_point = drag.start_mouse_point;
+      const auto drag_displacement = SDL_Point{
+          motion_event.x - start_mouse_point.x,
+          motion_event.y - start_mouse_point.y};
+      camera.position = viewport_to_world(
+          camera, {-drag_displacement.x, -drag_displacement.y});
+      result.is_processed = true;
+      result.is_redraw_needed = true;
+    }
+  } break;
+  case SDL_MOUSEWHEEL:
+    if (!io.WantCaptureMouse) {
+      auto& wheel_event = event.wheel;
+      render_state.camera.zoom_level += wheel_event.y;
+      result.is_processed = true;
+      result.is_redraw_needed = true;
+    }
+    break;
+  case SDL_QUIT:
+    result.is_quit = true;
+    break;
+  case SDL_WINDOWEVENT: {
+    auto& window_event = event.window;
+    if (window_event.event == SDL_WINDOWEVENT_CLOSE &&
+        window_event.windowID == window_id) {
+      result.is_quit = true;
+    }
+  } break;
+  default:
+    break;
+  }
+  if (!result.is_processed) {
+    result.is_redraw_needed |= ImGui_ImplSDL2_ProcessEvent(&event);
+  }
+  return result;
+}
+
+// Render caches are prepared on a worker thread when pipelined.
+struct Pipeline {
+  explicit Pipeline(std::function<void()> on_prepared)
+      : render_pipeline{std::move(on_prepared)} {}
+
+  RenderPipeline render_pipeline;
+  // Whether the world changed since the last frame request.
+  bool is_request_pending{};
+  // Whether each requested frame is waited for and presented at once,
+  // so that replayed frame times include preparing it.
+  bool is_waiting_for_frame{};
+};
+
+// Presents `state`.
+// If pipelined, presents the last frame prepared by the worker instead,
+// and requests that `state` be prepared for the next frame,
+// unless waiting for each frame, where `state` is prepared and shown.
+auto present_frame(
+    boni::SDL2::renderer& renderer, RenderState& state,
+    Pipeline* pipeline) -> int {
+  ImGui_ImplSDL2_NewFrame();
+  ImGui_ImplSDLRenderer2_NewFrame();
+  ImGui::NewFrame();
+
+  auto is_gui_changed = process_gui(state);
+  if (process_shapes_gui(state)) {
+    ++state.shape_revision;
+    is_gui_changed = true;
+  }
+  process_memory_gui();
+  const RenderState* frame = &state;
+  if (pipeline == nullptr) {
+    refresh_render_cache(state);
+  } else {
+    auto& render_pipeline = pipeline->render_pipeline;
+    render_pipeline.take_prepared_frame();
+    pipeline->is_request_pending |= is_gui_changed;
+    if (pipeline->is_request_pending &&
+        render_pipeline.request_frame(state)) {
+      pipeline->is_request_pending = false;
+      if (pipeline->is_waiting_for_frame) {
+        render_pipeline.wait_for_prepared_frame();
+      }
+    }
+    frame = &render_pipeline.front();
+  }
+  if (render(renderer, *frame) != 0) {
+    return -1;
   }
 
+  ImGui::Render();
+  ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData());
+  SDL_RenderPresent(renderer);
   return 0;
 }
 
-auto main(int /*argc*/, char** /*argv*/) -> int {
+struct Options {
+  // Path to record handled input events to.
+  const char* record_path{};
+  // Path of a recording to replay without a window.
+  const char* replay_path{};
+  // Whether to prepare render caches on a worker thread.
+  bool is_pipelined{};
+};
+
+auto parse_options(int argc, char** argv) -> std::optional<Options> {
+  auto options = Options{};
+  for (auto index = 1; index < argc; ++index) {
+    const auto argument = std::string{argv[index]};
+    const auto has_value = index + 1 < argc;
+    if (argument == "--record" && has_value) {
+      options.record_path = argv[++index];
+    } else if (argument == "--replay" && has_value) {
+      options.replay_path = argv[++index];
+    } else if (argument == "--pipelined") {
+      options.is_pipelined = true;
+    } else {
+      SDL_LogCritical(
+          SDL_LOG_CATEGORY_APPLICATION,
+          "Usage: %s [--pipelined] [--record FILE | --replay FILE]",
+          argv[0]);
+      return std::nullopt;
+    }
+  }
+  if (options.record_path != nullptr && options.replay_path != nullptr) {
+    SDL_LogCritical(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Cannot record and replay at the same time.");
+    return std::nullopt;
+  }
+  return options;
+}
+
+// Prints the duration of each replayed frame, one per line,
+// so that distributions from different builds can be compared,
+// followed by a summary to the log.
+void report_frame_times(std::vector<double>& frame_milliseconds) {
+  for (const auto milliseconds : frame_milliseconds) {
+    std::printf("%.3f\n", milliseconds);
+  }
+  if (frame_milliseconds.empty()) {
+    SDL_Log("Replayed no frames.");
+    return;
+  }
+  std::sort(frame_milliseconds.begin(), frame_milliseconds.end());
+  const auto percentile = [&frame_milliseconds](double fraction) {
+    const auto last = frame_milliseconds.size() - 1;
+    return frame_milliseconds[static_cast<std::size_t>(
+        fraction * static_cast<double>(last))];
+  };
+  auto total = 0.0;
+  for (const auto milliseconds : frame_milliseconds) {
+    total += milliseconds;
+  }
+  SDL_Log(
+      "Replayed %zu frames: mean %.3f ms, p50 %.3f ms, p95 %.3f ms, "
+      "p99 %.3f ms, max %.3f ms",
+      frame_milliseconds.size(),
+      total / static_cast<double>(frame_milliseconds.size()),
+      percentile(0.5), percentile(0.95), percentile(0.99),
+      frame_milliseconds.back());
+}
+
+auto main(int argc, char** argv) -> int {
+  const auto options_maybe = parse_options(argc, argv);
+  if (!options_maybe.has_value()) {
+    return 1;
+  }
+  const auto& options = options_maybe.value();
+  const auto is_replay = options.replay_path != nullptr;
+
+  auto replay_file = File{};
+  if (is_replay) {
+    replay_file.reset(std::fopen(options.replay_path, "rb"));
+    if (replay_file.get() == nullptr ||
+        !read_recording_header(replay_file)) {
+      SDL_LogCritical(
+          SDL_LOG_CATEGORY_APPLICATION, "Unable to replay file: %s",
+          options.replay_path);
+      return 1;
+    }
+    // Replays run headless, e.g. in CI.
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+  }
+  auto record_file = File{};
+  if (options.record_path != nullptr) {
+    record_file.reset(std::fopen(options.record_path, "wb"));
+    if (record_file.get() == nullptr ||
+        !write_recording_header(record_file)) {
+      SDL_LogCritical(
+          SDL_LOG_CATEGORY_APPLICATION, "Unable to record to file: %s",
+          options.record_path);
+      return 1;
+    }
+  }
+
   if (SDL_Init(SDL_INIT_VIDEO) != 0) {
     SDL_LogCritical(SDL_LOG_CATEGORY_SYSTEM, "%s", SDL_GetError());
     return 1;
@@ -175,14 +553,20 @@ auto main(int /*argc*/, char** /*argv*/) -> int {
     return 1;
   }
 
-  auto renderer = boni::SDL2::renderer{SDL_CreateRenderer(
-      window, -1, SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED)};
+  // Replays are not paced by vertical sync,
+  // so that frame times measure the work done.
+  const auto renderer_flags =
+      is_replay ? SDL_RENDERER_SOFTWARE
+                : SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED;
+  auto renderer = boni::SDL2::renderer{
+      SDL_CreateRenderer(window, -1, renderer_flags)};
   if (renderer.get() == nullptr) {
     SDL_LogCritical(SDL_LOG_CATEGORY_VIDEO, "%s", SDL_GetError());
     return 1;
   }
 
   IMGUI_CHECKVERSION();
+  ImGui::SetAllocatorFunctions(allocate_imgui_memory, free_imgui_memory);
   const auto imgui_context =
       boni::ImGui::context{ImGui::CreateContext()};
   if (imgui_context.get() == nullptr) {
@@ -191,6 +575,11 @@ auto main(int /*argc*/, char** /*argv*/) -> int {
     return 1;
   }
   ImGuiIO& io = ImGui::GetIO();
+  if (is_replay || record_file.get() != nullptr) {
+    // The saved window layout would differ between recording
+    // and replaying, so that replayed clicks miss their widgets.
+    io.IniFilename = nullptr;
+  }
 
   ImGui_ImplSDL2_InitForSDLRenderer(window, renderer);
 
@@ -206,7 +595,83 @@ auto main(int /*argc*/, char** /*argv*/) -> int {
   // const boni::cleanup<ImGui_ImplSDLRenderer2_Shutdown>
   //     _renderer_cleanup{};
 
+  const auto window_id = SDL_GetWindowID(window);
   auto render_state = RenderState{};
+  render_state.viewport_size = {window_width, window_height};
+
+  // Wakes up the event loop to present each prepared frame,
+  // so that input shows up one frame after it is handled.
+  const auto frame_prepared_event_type = SDL_RegisterEvents(1);
+  auto pipeline_maybe = std::optional<Pipeline>{};
+  if (options.is_pipelined && is_replay) {
+    // Replays wait for each requested frame instead of being woken up.
+    pipeline_maybe.emplace(nullptr).is_waiting_for_frame = true;
+  } else if (options.is_pipelined) {
+    pipeline_maybe.emplace([frame_prepared_event_type] {
+      SDL_Event event{};
+      event.type = frame_prepared_event_type;
+      SDL_PushEvent(&event);
+    });
+  }
+  auto* const pipeline =
+      pipeline_maybe.has_value() ? &pipeline_maybe.value() : nullptr;
+  if (is_replay) {
+    auto frame_milliseconds = std::vector<double>{};
+    const auto counter_frequency =
+        static_cast<double>(SDL_GetPerformanceFrequency());
+    auto frame_start = SDL_GetPerformanceCounter();
+    auto redraw_needed = false;
+    auto recorded_event = RecordedEvent{};
+    while (true) {
+      const auto status =
+          read_recorded_event(replay_file, recorded_event);
+      if (status == RecordReadStatus::end_of_file) {
+        break;
+      }
+      // Frame times of part of a session must not pass for all of it.
+      if (status == RecordReadStatus::malformed) {
+        SDL_LogCritical(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "Malformed record in replay file: %s", options.replay_path);
+        return 1;
+      }
+      if (recorded_event.type != RecordedEventType::frame_end) {
+        const auto event = to_sdl_event(recorded_event, window_id);
+        const auto result =
+            process_event(render_state, event, io, window_id);
+        redraw_needed |= result.is_redraw_needed;
+        if (pipeline != nullptr) {
+          pipeline->is_request_pending |= result.is_processed;
+        }
+        continue;
+      }
+      if (redraw_needed) {
+        if (present_frame(renderer, render_state, pipeline) != 0) {
+          SDL_LogCritical(SDL_LOG_CATEGORY_RENDER, "%s", SDL_GetError());
+          return 1;
+        }
+        const auto frame_stop = SDL_GetPerformanceCounter();
+        frame_milliseconds.push_back(
+            static_cast<double>(frame_stop - frame_start) * 1000.0 /
+            counter_frequency);
+      }
+      frame_start = SDL_GetPerformanceCounter();
+      redraw_needed = false;
+    }
+    report_frame_times(frame_milliseconds);
+    return 0;
+  }
+
+  const auto record = [&record_file](const RecordedEvent& event) {
+    if (record_file.get() == nullptr ||
+        write_recorded_event(record_file, event)) {
+      return;
+    }
+    SDL_LogError(
+        SDL_LOG_CATEGORY_APPLICATION,
+        "Stopped recording after failing to write.");
+    record_file.reset();
+  };
   while (true) {
     SDL_Event event;
     if (SDL_WaitEvent(&event) == 0) {
@@ -215,95 +680,31 @@ auto main(int /*argc*/, char** /*argv*/) -> int {
     }
     auto redraw_needed = false;
     do {
-      auto is_event_processed = false;
-      switch (event.type) {
-      case SDL_MOUSEBUTTONDOWN:
-        if (!io.WantCaptureMouse) {
-          const auto& button_event = event.button;
-          switch (button_event.button) {
-          case SDL_BUTTON_LEFT: {
-            const auto new_point = viewport_to_world(
-                render_state.camera, {button_event.x, button_event.y});
-            render_state.positions.push_back(new_point);
-            is_event_processed = true;
-            redraw_needed = true;
-          } break;
-          case SDL_BUTTON_RIGHT: {
-            auto& camera = render_state.camera;
-            camera.drag.emplace(
-                Drag{{button_event.x, button_event.y}, camera.position});
-            is_event_processed = true;
-          } break;
-          default:
-            break;
-          }
-        }
-        break;
-      case SDL_MOUSEBUTTONUP: {
-        auto& drag = render_state.camera.drag;
-        const auto& button_event = event.button;
-        if (drag.has_value() &&
-            button_event.button == SDL_BUTTON_RIGHT) {
-          drag.reset();
-          is_event_processed = true;
-        }
-      } break;
-      case SDL_MOUSEMOTION: {
-        auto& camera = render_state.camera;
-        auto& drag_maybe = camera.drag;
-        if (drag_maybe.has_value()) {
-          auto& drag = camera.drag.value();
-          camera.position = drag.start_position;
-          const auto& motion_event = event.motion;
-          const auto start_mouse_point = drag.start_mouse_point;
-          const auto drag_displacement = SDL_Point{
-              motion_event.x - start_mouse_point.x,
-              motion_event.y - start_mouse_point.y};
-          camera.position = viewport_to_world(
-              camera, {-drag_displacement.x, -drag_displacement.y});
-          is_event_processed = true;
-          redraw_needed = true;
-        }
-      } break;
-      case SDL_MOUSEWHEEL:
-        if (!io.WantCaptureMouse) {
-          auto& wheel_event = event.wheel;
-          render_state.camera.zoom_level += wheel_event.y;
-          is_event_processed = true;
-          redraw_needed = true;
-        }
-        break;
-      case SDL_QUIT:
+      if (event.type == frame_prepared_event_type) {
+        redraw_needed = true;
+        continue;
+      }
+      const auto result =
+          process_event(render_state, event, io, window_id);
+      if (result.is_quit) {
         return 0;
-      case SDL_WINDOWEVENT: {
-        auto& window_event = event.window;
-        if (window_event.event == SDL_WINDOWEVENT_CLOSE &&
-            window_event.windowID == SDL_GetWindowID(window)) {
-          return 0;
-        }
-      } break;
-      default:
-        break;
       }
-      if (!is_event_processed) {
-        redraw_needed |= ImGui_ImplSDL2_ProcessEvent(&event);
+      redraw_needed |= result.is_redraw_needed;
+      if (pipeline != nullptr) {
+        pipeline->is_request_pending |= result.is_processed;
+      }
+      const auto recorded_event = to_recorded_event(event);
+      if (recorded_event.has_value()) {
+        record(*recorded_event);
       }
     } while (SDL_PollEvent(&event) != 0);
+    record({RecordedEventType::frame_end, SDL_GetTicks()});
 
     if (redraw_needed) {
-      ImGui_ImplSDL2_NewFrame();
-      ImGui_ImplSDLRenderer2_NewFrame();
-      ImGui::NewFrame();
-
-      process_gui(render_state);
-      if (render(renderer, render_state) != 0) {
+      if (present_frame(renderer, render_state, pipeline) != 0) {
         SDL_LogCritical(SDL_LOG_CATEGORY_RENDER, "%s", SDL_GetError());
         return 1;
       }
-
-      ImGui::Render();
-      ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData());
-      SDL_RenderPresent(renderer);
     }
   }
 
@@ -0,0 +1,51 @@
+#pragma once
+
+// Internal headers.
+#include "boni/allocation.hpp"
+
+// Standard libraries.
+#include <array>
+#include <vector>
+
+// Subsystems that heap memory is accounted to.
+// Each is a tag for `boni::allocation::counting_allocator`.
+
+/** \brief Storage of spatial indices, such as quad-tree nodes. */
+struct IndexMemory {};
+/** \brief Storage of world positions and shapes. */
+struct PointMemory {};
+/** \brief Per-frame render caches, such as `draw_points`. */
+struct RenderCacheMemory {};
+/** \brief Allocations made by ImGui. */
+struct ImGuiMemory {};
+
+/** \brief A `std::vector` whose allocations are accounted to `Tag`. */
+template <typename Value, typename Tag>
+using TrackedVector =
+    std::vector<Value, boni::allocation::counting_allocator<Value, Tag>>;
+
+struct SubsystemStatistics {
+  const char* name;
+  boni::allocation::statistics values;
+};
+
+/** \brief Returns the memory use of every accounted subsystem. */
+inline auto get_memory_statistics()
+    -> std::array<SubsystemStatistics, 4> {
+  using boni::allocation::counter_of;
+  return {{
+      {"Index", counter_of<IndexMemory>.load()},
+      {"Points", counter_of<PointMemory>.load()},
+      {"Render cache", counter_of<RenderCacheMemory>.load()},
+      {"ImGui", counter_of<ImGuiMemory>.load()},
+  }};
+}
+
+/** \brief Lowers the peak of every subsystem to its live bytes. */
+inline void reset_memory_peaks() {
+  using boni::allocation::counter_of;
+  counter_of<IndexMemory>.reset_peak();
+  counter_of<PointMemory>.reset_peak();
+  counter_of<RenderCacheMemory>.reset_peak();
+  counter_of<ImGuiMemory>.reset_peak();
+}
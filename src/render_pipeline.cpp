@@ -0,0 +1,112 @@
+// Corresponding headers.
+#include "render_pipeline.hpp"
+
+// Standard libraries.
+#include <mutex>
+#include <utility>
+
+RenderPipeline::RenderPipeline(std::function<void()> on_prepared)
+    : on_prepared_{std::move(on_prepared)},
+      worker_{&RenderPipeline::run_worker, this} {}
+
+RenderPipeline::~RenderPipeline() {
+  is_stopping_.store(true);
+  wake_worker();
+  worker_.join();
+}
+
+auto RenderPipeline::request_frame(const RenderState& state) -> bool {
+  if (stage_.load(std::memory_order_acquire) != Stage::idle) {
+    return false;
+  }
+  const auto back_index = 1 - front_;
+  auto& back = buffers_[back_index];
+  // Positions may number in the tens of millions,
+  // so they are copied only into a copy holding other ones.
+  auto& copied_revision = copied_position_revisions_[back_index];
+  if (copied_revision != state.position_revision) {
+    back.positions.assign(
+        state.positions.cbegin(), state.positions.cend());
+    back.position_revision = state.position_revision;
+    copied_revision = state.position_revision;
+  }
+  // Shapes rarely change, so they are copied and reindexed
+  // only when the back copy was indexed for other ones.
+  if (back.indexed_shape_revision != state.shape_revision) {
+    back.rectangles.assign(
+        state.rectangles.cbegin(), state.rectangles.cend());
+    back.segments.assign(
+        state.segments.cbegin(), state.segments.cend());
+    back.shape_revision = state.shape_revision;
+  }
+  back.camera = state.camera;
+  back.neighbour_radius = state.neighbour_radius;
+  back.is_neighbour_lines_shown = state.is_neighbour_lines_shown;
+  back.viewport_size = state.viewport_size;
+  back.is_point_intensity_shown = state.is_point_intensity_shown;
+  stage_.store(Stage::requested);
+  wake_worker();
+  return true;
+}
+
+auto RenderPipeline::take_prepared_frame() -> bool {
+  if (stage_.load(std::memory_order_acquire) != Stage::prepared) {
+    return false;
+  }
+  front_ = 1 - front_;
+  stage_.store(Stage::idle, std::memory_order_release);
+  return true;
+}
+
+void RenderPipeline::wait_for_prepared_frame() {
+  // Spins rather than blocks, since frames take milliseconds at most
+  // and the handoff never takes a lock.
+  while (!take_prepared_frame()) {
+    std::this_thread::yield();
+  }
+}
+
+void RenderPipeline::wake_worker() {
+  // Sequentially consistent, like the store before it,
+  // so that either the worker sees that store before parking
+  // or this sees that the worker parks.
+  if (!is_worker_parked_.load()) {
+    return;
+  }
+  // Taking the lock ensures the worker is waiting
+  // rather than between checking the stage and waiting.
+  {
+    const std::lock_guard<std::mutex> lock{park_mutex_};
+  }
+  wake_.notify_one();
+}
+
+void RenderPipeline::run_worker() {
+  // Spins briefly before parking, since the next request often comes
+  // right after a frame is taken, and waking costs a system call.
+  constexpr auto max_spin_count = 64;
+  const auto is_woken = [this] {
+    return is_stopping_.load() || stage_.load() == Stage::requested;
+  };
+  auto spin_count = 0;
+  while (!is_stopping_.load(std::memory_order_relaxed)) {
+    if (stage_.load(std::memory_order_acquire) != Stage::requested) {
+      if (spin_count < max_spin_count) {
+        ++spin_count;
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock{park_mutex_};
+      is_worker_parked_.store(true);
+      wake_.wait(lock, is_woken);
+      is_worker_parked_.store(false);
+      continue;
+    }
+    spin_count = 0;
+    refresh_render_cache(buffers_[1 - front_]);
+    stage_.store(Stage::prepared, std::memory_order_release);
+    if (on_prepared_) {
+      on_prepared_();
+    }
+  }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// Internal headers.
+#include "render_state.hpp"
+
+// Standard libraries.
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// C Standard libraries.
+#include <cstddef>
+
+/** \brief Prepares render caches on a worker thread.
+ *
+ *  The pipeline owns two copies of `RenderState`.
+ *  The front copy holds the last prepared frame,
+ *  to be drawn by the main thread.
+ *  The back copy is refreshed by the worker
+ *  from a snapshot of the world and camera given to `request_frame`.
+ *  This lets the worker cull and transform the next frame
+ *  while the main thread submits and presents the current one.
+ *
+ *  Ownership of the back copy is handed between the threads
+ *  through a single atomic stage, without locks:
+ *
+ *  - `idle`: owned by the main thread, which may fill in a request.
+ *  - `requested`: owned by the worker, which refreshes it.
+ *  - `prepared`: owned by the main thread, which may swap it to front.
+ *
+ *  A worker that finds no request for a while parks
+ *  on a condition variable until the next one.
+ *  Only waking a parked worker takes the lock.
+ *
+ *  All member functions other than the constructor and destructor
+ *  must be called from the same thread.
+ */
+class RenderPipeline {
+public:
+  /** \brief Starts the worker.
+   *
+   *  \param on_prepared
+   *         Called from the worker thread after each prepared frame,
+   *         for example to wake up the main thread.
+   */
+  explicit RenderPipeline(std::function<void()> on_prepared);
+
+  /** \brief Stops and joins the worker. */
+  ~RenderPipeline();
+
+  RenderPipeline(const RenderPipeline&) = delete;
+  auto operator=(const RenderPipeline&) -> RenderPipeline& = delete;
+
+  /** \brief Starts preparing a frame of the given state.
+   *
+   *  Returns false without doing anything if the worker is busy
+   *  or a prepared frame has not been taken yet.
+   *  The state is copied, so it may be changed once this returns.
+   *  Positions and shapes are copied only if `position_revision`
+   *  and `shape_revision` have changed.
+   */
+  auto request_frame(const RenderState& state) -> bool;
+
+  /** \brief Moves a prepared frame, if any, to the front.
+   *
+   *  Returns whether there was a prepared frame.
+   */
+  auto take_prepared_frame() -> bool;
+
+  /** \brief Waits for the requested frame and moves it to the front.
+   *
+   *  Must only be called after a successful `request_frame`
+   *  whose frame has not been taken yet.
+   */
+  void wait_for_prepared_frame();
+
+  /** \brief Returns the last prepared frame taken. */
+  auto front() const -> const RenderState& { return buffers_[front_]; }
+
+private:
+  enum class Stage { idle, requested, prepared };
+
+  void run_worker();
+
+  /** \brief Wakes the worker if it is parked.
+   *
+   *  Called after changing `stage_` or `is_stopping_`.
+   */
+  void wake_worker();
+
+  std::array<RenderState, 2> buffers_;
+  // Only changed by the main thread, while the worker is not using it.
+  std::size_t front_{0};
+  // The `position_revision` each copy holds, if any.
+  std::array<std::optional<std::size_t>, 2> copied_position_revisions_;
+  std::atomic<Stage> stage_{Stage::idle};
+  std::atomic<bool> is_stopping_{false};
+  // Set by the worker, under `park_mutex_`, before parking.
+  std::atomic<bool> is_worker_parked_{false};
+  std::mutex park_mutex_;
+  std::condition_variable wake_;
+  std::function<void()> on_prepared_;
+  std::thread worker_;
+};
@@ -0,0 +1,352 @@
+// Corresponding headers.
+#include "render_state.hpp"
+
+// External dependencies.
+#include <boost/numeric/conversion/cast.hpp>
+
+// Standard libraries.
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <optional>
+
+// C Standard libraries.
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+// A world point with fractional coordinates, e.g. from clipping.
+using WorldPoint = std::array<double, 2>;
+
+// Converts to `int`, saturating at the ends of its range.
+auto saturate_to_int(double value) -> int {
+  constexpr auto min = std::numeric_limits<int>::min();
+  constexpr auto max = std::numeric_limits<int>::max();
+  if (!(value > min)) {
+    return min;
+  }
+  if (!(value < max)) {
+    return max;
+  }
+  return static_cast<int>(value);
+}
+
+// Transforms a point of the visible world box to the viewport.
+// Rounds like `world_to_viewport`, but clamps to just outside
+// the viewport, so that the conversion cannot overflow
+// however far the camera is zoomed in.
+auto visible_world_to_viewport(
+    const Camera& camera, double zoom, SDL_Point viewport_size,
+    WorldPoint point) -> SDL_Point {
+  const auto transform = [&](std::size_t axis, int size) -> int {
+    const auto relative = static_cast<float>(
+        point[axis] - static_cast<double>(camera.position[axis]));
+    return static_cast<int>(
+        std::clamp(relative * zoom, -1.0, size + 1.0));
+  };
+  return {transform(0, viewport_size.x), transform(1, viewport_size.y)};
+}
+
+// Returns the range of `[0, 1]` along the segment within `box`,
+// if any.
+auto clip(const Segment& segment, const Box& box)
+    -> std::optional<std::array<double, 2>> {
+  auto range = std::array<double, 2>{0.0, 1.0};
+  for (std::size_t axis = 0; axis < 2; ++axis) {
+    const auto start = static_cast<double>(segment.start[axis]);
+    const auto delta = static_cast<double>(segment.end[axis]) - start;
+    const auto min = static_cast<double>(box.min[axis]);
+    const auto max = static_cast<double>(box.max[axis]);
+    if (delta == 0.0) {
+      if (start < min || max < start) {
+        return std::nullopt;
+      }
+      continue;
+    }
+    auto enter = (min - start) / delta;
+    auto leave = (max - start) / delta;
+    if (enter > leave) {
+      std::swap(enter, leave);
+    }
+    range[0] = std::max(range[0], enter);
+    range[1] = std::min(range[1], leave);
+    if (range[0] > range[1]) {
+      return std::nullopt;
+    }
+  }
+  return range;
+}
+
+auto point_along(const Segment& segment, double fraction)
+    -> WorldPoint {
+  const auto along = [&](std::size_t axis) {
+    const auto start = static_cast<double>(segment.start[axis]);
+    const auto end = static_cast<double>(segment.end[axis]);
+    return start + (end - start) * fraction;
+  };
+  return {along(0), along(1)};
+}
+
+// Rebuilds the shape indices if the shapes changed since last time.
+void index_shapes(RenderState& state) {
+  if (state.indexed_shape_revision == state.shape_revision) {
+    return;
+  }
+  state.rectangle_index.build(state.rectangles);
+  const auto& segments = state.segments;
+  auto& segment_bounds = state.segment_bounds;
+  segment_bounds.clear();
+  std::transform(
+      segments.cbegin(), segments.cend(),
+      std::back_inserter(segment_bounds),
+      [](const Segment& segment) -> Box {
+        return {
+            {std::min(segment.start[0], segment.end[0]),
+             std::min(segment.start[1], segment.end[1])},
+            {std::max(segment.start[0], segment.end[0]),
+             std::max(segment.start[1], segment.end[1])}};
+      });
+  state.segment_index.build(segment_bounds);
+  state.indexed_shape_revision = state.shape_revision;
+}
+
+} // namespace
+
+auto get_render_workers() -> boni::parallel::worker_pool& {
+  static auto workers = boni::parallel::worker_pool{};
+  return workers;
+}
+
+auto get_zoom(const Camera& camera) -> double {
+  return std::pow(ZOOM_PER_LEVEL, camera.zoom_level);
+}
+
+auto viewport_to_world(
+    const Camera& camera, const SDL_Point viewport_point) -> Position {
+  const auto zoom = get_zoom(camera);
+  const auto world_point_relative_to_camera_x =
+      static_cast<float>(viewport_point.x) / zoom;
+  const auto world_point_relative_to_camera_y =
+      static_cast<float>(viewport_point.y) / zoom;
+  const auto camera_position = camera.position;
+  return {
+      boost::numeric_cast<int>(world_point_relative_to_camera_x) +
+          camera_position[0],
+      boost::numeric_cast<int>(world_point_relative_to_camera_y) +
+          camera_position[1]};
+}
+
+auto world_to_viewport(const Camera& camera, const Position world_point)
+    -> SDL_Point {
+  const auto camera_position = camera.position;
+  const auto world_point_relative_to_camera_x = static_cast<float>(
+      std::int64_t{world_point[0]} - camera_position[0]);
+  const auto world_point_relative_to_camera_y = static_cast<float>(
+      std::int64_t{world_point[1]} - camera_position[1]);
+  const auto zoom = get_zoom(camera);
+  return {
+      boost::numeric_cast<int>(world_point_relative_to_camera_x * zoom),
+      boost::numeric_cast<int>(world_point_relative_to_camera_y * zoom)
+
+  };
+}
+
+void refresh_positions_render_cache(RenderState& state) {
+  using boni::pixel_occupancy::pixel;
+  const auto& positions = state.positions;
+  const auto camera_position = state.camera.position;
+  const auto zoom = get_zoom(state.camera);
+  const auto viewport_size = state.viewport_size;
+  const auto viewport_width = static_cast<double>(viewport_size.x);
+  const auto viewport_height = static_cast<double>(viewport_size.y);
+  auto& occupancy = state.point_occupancy;
+  occupancy.reset(
+      viewport_size.x, viewport_size.y,
+      state.is_point_intensity_shown ? POINT_INTENSITY_LEVEL_COUNT : 1);
+  occupancy.mark(
+      positions.size(), [&](std::size_t index) -> std::optional<pixel> {
+        // Rounds like `world_to_viewport`, but culls first,
+        // so that the conversion cannot throw in a worker.
+        const auto& position = positions[index];
+        const auto transform = [&](std::size_t axis) {
+          return static_cast<float>(
+                     std::int64_t{position[axis]} -
+                     camera_position[axis]) *
+                 zoom;
+        };
+        const auto x = transform(0);
+        const auto y = transform(1);
+        if (!(x > -1.0 && x < viewport_width && y > -1.0 &&
+              y < viewport_height)) {
+          return std::nullopt;
+        }
+        return pixel{static_cast<int>(x), static_cast<int>(y)};
+      },
+      get_render_workers());
+
+  auto& draw_points = state.draw_points;
+  draw_points.resize(occupancy.occupied_count());
+  occupancy.for_each_occupied(
+      [&draw_points](std::size_t offset, pixel target) {
+        draw_points[offset] = SDL_Point{target[0], target[1]};
+      },
+      get_render_workers());
+}
+
+void refresh_neighbour_lines_render_cache(RenderState& state) {
+  auto& pairs_per_worker = state.neighbour_pairs;
+  auto& line_points = state.neighbour_line_points;
+  for (auto& pairs : pairs_per_worker) {
+    pairs.clear();
+  }
+  line_points.clear();
+  const auto& camera = state.camera;
+  if (!state.is_neighbour_lines_shown ||
+      get_zoom(camera) < MIN_NEIGHBOUR_LINE_ZOOM) {
+    return;
+  }
+
+  // Only lines crossing the visible box are kept,
+  // so that off-screen pairs do not use up the cap.
+  const auto& positions = state.positions;
+  const auto visible_box = get_visible_world_box(state);
+  auto& index = state.position_index;
+  if (state.indexed_position_revision != state.position_revision) {
+    index.build(positions);
+    state.indexed_position_revision = state.position_revision;
+  }
+  boni::quad_tree::for_each_pair_within(
+      index, state.neighbour_radius,
+      [&](std::size_t worker, std::size_t first, std::size_t second) {
+        auto& pairs = pairs_per_worker[worker];
+        if (pairs.size() < MAX_NEIGHBOUR_LINES_PER_WORKER &&
+            clip(Segment{positions[first], positions[second]},
+                 visible_box)
+                .has_value()) {
+          pairs.emplace_back(first, second);
+        }
+      },
+      get_render_workers(), visible_box);
+
+  // Which worker finds which pairs changes from frame to frame,
+  // so every list is made to fit all of them,
+  // so that refreshing the same world again does not allocate.
+  auto pair_count = std::size_t{0};
+  for (const auto& pairs : pairs_per_worker) {
+    pair_count += pairs.size();
+  }
+  for (auto& pairs : pairs_per_worker) {
+    pairs.reserve(std::min(pair_count, MAX_NEIGHBOUR_LINES_PER_WORKER));
+  }
+
+  // Clipped before being transformed,
+  // since endpoints far off-screen do not fit the viewport type.
+  const auto zoom = get_zoom(camera);
+  for (const auto& pairs : pairs_per_worker) {
+    for (const auto& [first, second] : pairs) {
+      const auto line = Segment{positions[first], positions[second]};
+      const auto [begin, end] = *clip(line, visible_box);
+      for (const auto fraction : {begin, end}) {
+        line_points.push_back(visible_world_to_viewport(
+            camera, zoom, state.viewport_size,
+            point_along(line, fraction)));
+      }
+    }
+  }
+}
+
+auto get_visible_world_box(const RenderState& state) -> Box {
+  // Computed in `double` and saturated,
+  // since zoomed out far enough the viewport spans more than `int`.
+  const auto& camera = state.camera;
+  const auto zoom = get_zoom(camera);
+  const auto corner = [&](std::size_t axis, int size) -> int {
+    return saturate_to_int(
+        static_cast<double>(camera.position[axis]) +
+        std::ceil(size / zoom));
+  };
+  const auto& viewport_size = state.viewport_size;
+  return {
+      camera.position,
+      {corner(0, viewport_size.x), corner(1, viewport_size.y)}};
+}
+
+void refresh_shapes_render_cache(RenderState& state) {
+  // Shapes are clipped to the visible box before being transformed,
+  // since corners far off-screen do not fit the viewport type.
+  const auto& camera = state.camera;
+  const auto zoom = get_zoom(camera);
+  const auto viewport_size = state.viewport_size;
+  const auto visible_box = get_visible_world_box(state);
+  const auto to_viewport = [&](WorldPoint point) {
+    return visible_world_to_viewport(
+        camera, zoom, viewport_size, point);
+  };
+
+  index_shapes(state);
+  auto& draw_rectangles = state.draw_rectangles;
+  draw_rectangles.clear();
+  const auto& rectangles = state.rectangles;
+  state.rectangle_index.for_each_overlapping(
+      visible_box, [&](std::size_t rectangle) {
+        const auto& bounds = rectangles[rectangle];
+        const auto min = to_viewport(
+            {static_cast<double>(
+                 std::max(bounds.min[0], visible_box.min[0])),
+             static_cast<double>(
+                 std::max(bounds.min[1], visible_box.min[1]))});
+        const auto max = to_viewport(
+            {static_cast<double>(
+                 std::min(bounds.max[0], visible_box.max[0])),
+             static_cast<double>(
+                 std::min(bounds.max[1], visible_box.max[1]))});
+        draw_rectangles.push_back(SDL_Rect{
+            min.x, min.y, std::max(max.x - min.x, 1),
+            std::max(max.y - min.y, 1)});
+      });
+
+  const auto& segments = state.segments;
+  auto& visible_segments = state.visible_segments;
+  visible_segments.clear();
+  state.segment_index.for_each_overlapping(
+      visible_box, [&visible_segments](std::size_t segment) {
+        visible_segments.push_back(segment);
+      });
+  // Kept in list order, so that segments entered as a path
+  // are joined back into one polyline to draw with one call.
+  std::sort(visible_segments.begin(), visible_segments.end());
+
+  auto& polyline_points = state.segment_polyline_points;
+  auto& polyline_sizes = state.segment_polyline_sizes;
+  polyline_points.clear();
+  polyline_sizes.clear();
+  // Joined only where neither segment was clipped at the joint.
+  const Segment* previous = nullptr;
+  for (const auto index : visible_segments) {
+    const auto& segment = segments[index];
+    const auto range = clip(segment, visible_box);
+    if (!range.has_value()) {
+      previous = nullptr;
+      continue;
+    }
+    const auto [begin, end] = *range;
+    if (previous == nullptr || previous->end != segment.start ||
+        begin != 0.0) {
+      polyline_points.push_back(
+          to_viewport(point_along(segment, begin)));
+      polyline_sizes.push_back(1);
+    }
+    polyline_points.push_back(to_viewport(point_along(segment, end)));
+    ++polyline_sizes.back();
+    previous = end == 1.0 ? &segment : nullptr;
+  }
+}
+
+void refresh_render_cache(RenderState& state) {
+  refresh_neighbour_lines_render_cache(state);
+  refresh_shapes_render_cache(state);
+  refresh_positions_render_cache(state);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+// Internal headers.
+#include "boni/loose_quad_tree.hpp"
+#include "boni/pixel_occupancy.hpp"
+#include "boni/quad_tree.hpp"
+#include "boni/worker_pool.hpp"
+#include "memory_accounting.hpp"
+
+// External dependencies.
+#include <SDL.h>
+
+// Standard libraries.
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+// C Standard libraries.
+#include <cstddef>
+#include <cstdint>
+
+constexpr auto ZOOM_PER_LEVEL{0.9f};
+// Neighbour lines are too dense to be useful when zoomed out.
+constexpr auto MIN_NEIGHBOUR_LINE_ZOOM{1.0f};
+// Per worker, so that a dense cluster cannot exhaust memory.
+constexpr auto MAX_NEIGHBOUR_LINES_PER_WORKER = std::size_t{1} << 16;
+// Brightness levels of points, by how many positions share a pixel.
+constexpr auto POINT_INTENSITY_LEVEL_COUNT = std::size_t{4};
+
+using Position = boni::quad_tree::point;
+using NeighbourPairs = TrackedVector<
+    std::pair<std::size_t, std::size_t>, RenderCacheMemory>;
+using PositionIndex = boni::quad_tree::basic_tree<
+    boni::allocation::counting_allocator<Position, IndexMemory>>;
+using Box = boni::quad_tree::box;
+using ShapeIndex = boni::quad_tree::basic_loose_tree<
+    boni::allocation::counting_allocator<Box, IndexMemory>>;
+using PointOccupancy = boni::pixel_occupancy::basic_grid<
+    boni::allocation::counting_allocator<
+        std::uint64_t, RenderCacheMemory>>;
+
+/** \brief Returns the threads that refresh render caches.
+ *
+ *  Started on first use and shared by every `RenderState`,
+ *  so that refreshing does not start threads.
+ */
+auto get_render_workers() -> boni::parallel::worker_pool&;
+
+struct Segment {
+  Position start{0, 0};
+  Position end{0, 0};
+};
+
+struct Drag {
+  SDL_Point start_mouse_point{0, 0};
+  Position start_position{0, 0};
+};
+
+struct Camera {
+  Position position;
+  int zoom_level{};
+  std::optional<Drag> drag;
+};
+
+struct RenderState {
+  TrackedVector<Position, PointMemory> positions;
+  // Incremented whenever `positions` change,
+  // so that unchanged positions are not copied again.
+  std::size_t position_revision{};
+  // Pixels covered by visible positions, each listed once,
+  // grouped by `point_occupancy.level_sizes()`.
+  TrackedVector<SDL_Point, RenderCacheMemory> draw_points;
+  PointOccupancy point_occupancy;
+  // Whether pixels covering more positions are drawn brighter.
+  bool is_point_intensity_shown{};
+  Camera camera;
+  // Whether lines are drawn between positions within
+  // `neighbour_radius` of each other.
+  bool is_neighbour_lines_shown{};
+  // The `position_revision` the position index was last built for.
+  std::optional<std::size_t> indexed_position_revision;
+  PositionIndex position_index;
+  int neighbour_radius{32};
+  // One list per render worker.
+  TrackedVector<NeighbourPairs, RenderCacheMemory> neighbour_pairs{
+      get_render_workers().worker_count()};
+  TrackedVector<SDL_Point, RenderCacheMemory> neighbour_line_points;
+  // Size of the viewport, used for culling.
+  SDL_Point viewport_size{0, 0};
+  TrackedVector<Box, PointMemory> rectangles;
+  TrackedVector<Segment, PointMemory> segments;
+  // Incremented whenever `rectangles` or `segments` change,
+  // so that the shape indices are rebuilt only then.
+  std::size_t shape_revision{};
+  // The `shape_revision` the shape indices were last built for.
+  std::optional<std::size_t> indexed_shape_revision;
+  ShapeIndex rectangle_index;
+  ShapeIndex segment_index;
+  TrackedVector<Box, IndexMemory> segment_bounds;
+  TrackedVector<std::size_t, RenderCacheMemory> visible_segments;
+  TrackedVector<SDL_Rect, RenderCacheMemory> draw_rectangles;
+  // Visible segments, joined into polylines where they connect.
+  // Each polyline is `segment_polyline_sizes[i]` points long.
+  TrackedVector<SDL_Point, RenderCacheMemory> segment_polyline_points;
+  TrackedVector<int, RenderCacheMemory> segment_polyline_sizes;
+};
+
+auto get_zoom(const Camera& camera) -> double;
+
+auto viewport_to_world(
+    const Camera& camera, const SDL_Point viewport_point) -> Position;
+
+auto world_to_viewport(const Camera& camera, const Position world_point)
+    -> SDL_Point;
+
+/** \brief Lists the pixels covered by visible positions.
+ *
+ *  Each pixel is listed once however many positions it covers,
+ *  so `draw_points` never outgrows the pixel count of the viewport.
+ */
+void refresh_positions_render_cache(RenderState& state);
+
+/** \brief Lists lines between visible positions near each other,
+ *         if `is_neighbour_lines_shown`.
+ *
+ *  The position index is rebuilt only when `position_revision`
+ *  has changed since it was last built.
+ */
+void refresh_neighbour_lines_render_cache(RenderState& state);
+
+/** \brief Returns the world region visible in the viewport. */
+auto get_visible_world_box(const RenderState& state) -> Box;
+
+/** \brief Culls rectangles and segments to the visible region
+ *         using loose quad-trees, and transforms them for drawing.
+ *
+ *  The trees are rebuilt only when `shape_revision` has changed
+ *  since they were last built.
+ */
+void refresh_shapes_render_cache(RenderState& state);
+
+/** \brief Refreshes every render cache from the world and camera.
+ *
+ *  Caches keep their storage between calls,
+ *  so once they have grown to fit,
+ *  refreshing for an unchanged world does not allocate.
+ */
+void refresh_render_cache(RenderState& state);
@@ -0,0 +1,62 @@
+#pragma once
+
+// Internal headers.
+#include <boni/pixel_occupancy.hpp>
+#include <boni/quad_tree.hpp>
+
+// Standard libraries.
+#include <cstddef>
+#include <random>
+#include <vector>
+
+// Generators of random input shared by tests and benchmarks.
+// Each takes a seed, so that every run sees the same input.
+
+// Returns points spread uniformly over `[-extent, extent]^2`.
+inline auto make_random_points(
+    std::size_t count, int extent, unsigned seed)
+    -> std::vector<boni::quad_tree::point> {
+  auto generator = std::mt19937{seed};
+  auto distribution =
+      std::uniform_int_distribution<int>{-extent, extent};
+  auto points = std::vector<boni::quad_tree::point>(count);
+  for (auto& point : points) {
+    point = {distribution(generator), distribution(generator)};
+  }
+  return points;
+}
+
+// Returns boxes with their `min` corner in `[-extent, extent]^2`
+// and each side up to `max_size` long.
+inline auto make_random_boxes(
+    std::size_t count, int extent, int max_size, unsigned seed)
+    -> std::vector<boni::quad_tree::box> {
+  auto generator = std::mt19937{seed};
+  auto position = std::uniform_int_distribution<int>{-extent, extent};
+  auto size = std::uniform_int_distribution<int>{0, max_size};
+  auto boxes = std::vector<boni::quad_tree::box>(count);
+  for (auto& object : boxes) {
+    object.min = {position(generator), position(generator)};
+    const auto width = size(generator);
+    const auto height = size(generator);
+    object.max = {object.min[0] + width, object.min[1] + height};
+  }
+  return boxes;
+}
+
+// Returns pixels spread over a `width` by `height` grid
+// and two pixels past it on every side.
+inline auto make_random_pixels(
+    std::size_t count, int width, int height, unsigned seed)
+    -> std::vector<boni::pixel_occupancy::pixel> {
+  auto generator = std::mt19937{seed};
+  auto x_distribution =
+      std::uniform_int_distribution<int>{-2, width + 1};
+  auto y_distribution =
+      std::uniform_int_distribution<int>{-2, height + 1};
+  auto pixels = std::vector<boni::pixel_occupancy::pixel>(count);
+  for (auto& target : pixels) {
+    target = {x_distribution(generator), y_distribution(generator)};
+  }
+  return pixels;
+}
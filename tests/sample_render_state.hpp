@@ -0,0 +1,22 @@
+#pragma once
+
+// Internal headers.
+#include <render_state.hpp>
+
+// Returns a world of evenly spaced positions, rectangles
+// and a row of connected segments, larger than the viewport.
+// Positions are 8 apart, starting from the origin.
+inline auto make_render_state() -> RenderState {
+  auto state = RenderState{};
+  state.viewport_size = {1280, 720};
+  for (auto x = 0; x < 100; ++x) {
+    for (auto y = 0; y < 100; ++y) {
+      state.positions.push_back({x * 8, y * 8});
+      const auto corner = Position{x * 16, y * 16};
+      state.rectangles.push_back(
+          {corner, {corner[0] + 8, corner[1] + 8}});
+    }
+    state.segments.push_back({{x * 16, 0}, {x * 16 + 16, 0}});
+  }
+  return state;
+}
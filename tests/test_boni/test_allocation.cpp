@@ -0,0 +1,69 @@
+// Corresponding headers.
+#include <boni/allocation.hpp>
+
+// External libraries.
+#include <catch.hpp>
+
+// Standard libraries.
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+template <typename tag_t> auto live_bytes() {
+  return boni::allocation::counter_of<tag_t>.load().live_bytes;
+}
+
+} // namespace
+
+TEST_CASE("counting_allocator records vector storage") {
+  struct tag {};
+  {
+    std::vector<int, boni::allocation::counting_allocator<int, tag>>
+        values;
+    values.reserve(16);
+    REQUIRE(live_bytes<tag>() == 16 * sizeof(int));
+  }
+  REQUIRE(live_bytes<tag>() == 0);
+  const auto statistics = boni::allocation::counter_of<tag>.load();
+  REQUIRE(statistics.peak_bytes == 16 * sizeof(int));
+  REQUIRE(statistics.allocation_count == 1);
+}
+
+TEST_CASE("counting_allocator records rebound node storage") {
+  struct tag {};
+  using value_type = std::pair<const int, int>;
+  using allocator =
+      boni::allocation::counting_allocator<value_type, tag>;
+  {
+    std::map<int, int, std::less<int>, allocator> values;
+    values[1] = 1;
+    values[2] = 2;
+    REQUIRE(live_bytes<tag>() > 0);
+  }
+  REQUIRE(live_bytes<tag>() == 0);
+}
+
+TEST_CASE("counter peak is kept until reset") {
+  boni::allocation::counter counter;
+  counter.on_allocate(10);
+  counter.on_allocate(5);
+  counter.on_deallocate(10);
+  REQUIRE(counter.load().live_bytes == 5);
+  REQUIRE(counter.load().peak_bytes == 15);
+  counter.reset_peak();
+  REQUIRE(counter.load().peak_bytes == 5);
+}
+
+TEST_CASE("malloc_counted records until free_counted") {
+  boni::allocation::counter counter;
+  auto* const pointer = boni::allocation::malloc_counted(counter, 100);
+  REQUIRE(pointer != nullptr);
+  REQUIRE(counter.load().live_bytes == 100);
+  boni::allocation::free_counted(counter, pointer);
+  REQUIRE(counter.load().live_bytes == 0);
+  boni::allocation::free_counted(counter, nullptr);
+  REQUIRE(counter.load().allocation_count == 1);
+}
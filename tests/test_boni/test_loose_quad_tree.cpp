@@ -0,0 +1,106 @@
+// Corresponding headers.
+#include <boni/loose_quad_tree.hpp>
+
+// Internal headers.
+#include <random_geometry.hpp>
+
+// External libraries.
+#include <catch.hpp>
+
+// Standard libraries.
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+auto find_overlapping(
+    const boni::quad_tree::loose_tree& index,
+    const boni::quad_tree::box& query) -> std::vector<std::size_t> {
+  auto found = std::vector<std::size_t>{};
+  index.for_each_overlapping(
+      query, [&found](std::size_t object) { found.push_back(object); });
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+auto find_overlapping_brute_force(
+    const std::vector<boni::quad_tree::box>& boxes,
+    const boni::quad_tree::box& query) -> std::vector<std::size_t> {
+  auto found = std::vector<std::size_t>{};
+  for (std::size_t object = 0; object < boxes.size(); ++object) {
+    if (boni::quad_tree::overlaps(boxes[object], query)) {
+      found.push_back(object);
+    }
+  }
+  return found;
+}
+
+} // namespace
+
+TEST_CASE("overlaps includes touching boxes") {
+  const auto left = boni::quad_tree::box{{0, 0}, {2, 2}};
+  REQUIRE(boni::quad_tree::overlaps(left, {{2, 2}, {3, 3}}));
+  REQUIRE(!boni::quad_tree::overlaps(left, {{3, 0}, {4, 2}}));
+  REQUIRE(!boni::quad_tree::overlaps(left, {{0, -2}, {2, -1}}));
+}
+
+TEST_CASE("loose_tree of no boxes finds nothing") {
+  auto index = boni::quad_tree::loose_tree{};
+  index.build({});
+  REQUIRE(index.empty());
+  REQUIRE(find_overlapping(index, {{-10, -10}, {10, 10}}).empty());
+}
+
+TEST_CASE("loose_tree stores every box in exactly one node") {
+  const auto boxes = make_random_boxes(2000, 1000, 200, 1);
+  auto index = boni::quad_tree::loose_tree{4};
+  index.build(boxes);
+  auto stored = std::vector<int>(boxes.size(), 0);
+  for (const auto& node : index.nodes()) {
+    for (auto position = node.begin; position < node.own_end;
+         ++position) {
+      ++stored[index.indices()[position]];
+      const auto& object = index.boxes()[position];
+      REQUIRE(node.bounds.min[0] <= object.min[0]);
+      REQUIRE(node.bounds.min[1] <= object.min[1]);
+      REQUIRE(object.max[0] <= node.bounds.max[0]);
+      REQUIRE(object.max[1] <= node.bounds.max[1]);
+    }
+  }
+  REQUIRE(std::all_of(stored.cbegin(), stored.cend(), [](int count) {
+    return count == 1;
+  }));
+}
+
+TEST_CASE("loose_tree pushes small boxes below the root") {
+  const auto boxes = make_random_boxes(2000, 1000, 10, 2);
+  auto index = boni::quad_tree::loose_tree{4};
+  index.build(boxes);
+  const auto& root = index.nodes().front();
+  REQUIRE(root.own_end - root.begin < boxes.size() / 10);
+}
+
+TEST_CASE("loose_tree overlap queries match brute force") {
+  const auto boxes = make_random_boxes(2000, 1000, 300, 3);
+  auto index = boni::quad_tree::loose_tree{};
+  index.build(boxes);
+  const auto queries = make_random_boxes(50, 1000, 500, 4);
+  for (const auto& query : queries) {
+    REQUIRE(
+        find_overlapping(index, query) ==
+        find_overlapping_brute_force(boxes, query));
+  }
+  const auto point_query = boni::quad_tree::box{{0, 0}, {0, 0}};
+  REQUIRE(
+      find_overlapping(index, point_query) ==
+      find_overlapping_brute_force(boxes, point_query));
+}
+
+TEST_CASE("loose_tree splits no further than coincident boxes") {
+  const auto boxes = std::vector<boni::quad_tree::box>(
+      100, boni::quad_tree::box{{-5, -5}, {-4, -4}});
+  auto index = boni::quad_tree::loose_tree{4};
+  index.build(boxes);
+  REQUIRE(find_overlapping(index, {{-4, -4}, {0, 0}}).size() == 100);
+}
@@ -0,0 +1,155 @@
+// Corresponding headers.
+#include <boni/pixel_occupancy.hpp>
+
+// Internal headers.
+#include <boni/allocation.hpp>
+#include <random_geometry.hpp>
+
+// External libraries.
+#include <catch.hpp>
+
+// Standard libraries.
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace {
+
+using boni::pixel_occupancy::pixel;
+
+auto list_occupied(
+    boni::pixel_occupancy::grid& occupancy,
+    const std::vector<pixel>& pixels,
+    boni::parallel::worker_pool& workers) -> std::vector<pixel> {
+  occupancy.mark(
+      pixels.size(),
+      [&pixels](std::size_t index) -> std::optional<pixel> {
+        return pixels[index];
+      },
+      workers);
+  auto occupied = std::vector<pixel>(occupancy.occupied_count());
+  occupancy.for_each_occupied(
+      [&occupied](std::size_t offset, pixel target) {
+        occupied[offset] = target;
+      },
+      workers);
+  return occupied;
+}
+
+} // namespace
+
+TEST_CASE("pixel_occupancy lists each hit pixel once in row order") {
+  auto workers = boni::parallel::worker_pool{1};
+  auto occupancy = boni::pixel_occupancy::grid{};
+  occupancy.reset(4, 3);
+  const auto occupied = list_occupied(
+      occupancy, {{3, 2}, {1, 0}, {3, 2}, {0, 2}, {1, 0}, {3, 2}},
+      workers);
+  REQUIRE(occupied == std::vector<pixel>{{1, 0}, {0, 2}, {3, 2}});
+}
+
+TEST_CASE("pixel_occupancy skips points outside the grid") {
+  auto workers = boni::parallel::worker_pool{1};
+  auto occupancy = boni::pixel_occupancy::grid{};
+  occupancy.reset(2, 2);
+  occupancy.mark(
+      4,
+      [](std::size_t index) -> std::optional<pixel> {
+        switch (index) {
+        case 0:
+          return pixel{-1, 0};
+        case 1:
+          return pixel{0, 2};
+        case 2:
+          return std::nullopt;
+        default:
+          return pixel{1, 1};
+        }
+      },
+      workers);
+  REQUIRE(occupancy.occupied_count() == 1);
+}
+
+TEST_CASE("pixel_occupancy is empty for an empty grid") {
+  auto workers = boni::parallel::worker_pool{4};
+  auto occupancy = boni::pixel_occupancy::grid{};
+  occupancy.reset(0, 0);
+  REQUIRE(list_occupied(occupancy, {{0, 0}}, workers).empty());
+}
+
+TEST_CASE("pixel_occupancy clears only the workers that mark") {
+  struct grid_memory {};
+  using counted_grid = boni::pixel_occupancy::basic_grid<
+      boni::allocation::counting_allocator<std::uint64_t, grid_memory>>;
+  const auto& counter = boni::allocation::counter_of<grid_memory>;
+  auto workers = boni::parallel::worker_pool{8};
+  auto occupancy = counted_grid{};
+  occupancy.reset(640, 480, 4);
+  // Few enough points for a single chunk, and so a single worker.
+  occupancy.mark(
+      10,
+      [](std::size_t index) -> std::optional<pixel> {
+        return pixel{static_cast<int>(index), 0};
+      },
+      workers);
+  REQUIRE(occupancy.occupied_count() == 10);
+  const auto bitmap_bytes = 10 * 480 * sizeof(std::uint64_t);
+  const auto hit_bytes = std::size_t{640} * 480;
+  REQUIRE(counter.load().live_bytes < 2 * (bitmap_bytes + hit_bytes));
+}
+
+TEST_CASE("pixel_occupancy groups pixels by hit count") {
+  auto workers = boni::parallel::worker_pool{1};
+  auto occupancy = boni::pixel_occupancy::grid{};
+  occupancy.reset(8, 1, 4);
+  auto pixels = std::vector<pixel>{};
+  // Hit 1, 2, 4 and 300 times, the last saturating.
+  const std::size_t hit_counts[] = {1, 2, 4, 300};
+  for (std::size_t column = 0; column < 4; ++column) {
+    pixels.insert(
+        pixels.end(), hit_counts[column],
+        pixel{static_cast<int>(7 - column), 0});
+  }
+  // A second pixel in the lowest level.
+  pixels.push_back({0, 0});
+  const auto occupied = list_occupied(occupancy, pixels, workers);
+  REQUIRE(
+      occupancy.level_sizes() == std::vector<std::size_t>{2, 1, 1, 1});
+  REQUIRE(
+      occupied ==
+      std::vector<pixel>{{0, 0}, {7, 0}, {6, 0}, {5, 0}, {4, 0}});
+}
+
+TEST_CASE("pixel_occupancy matches a single worker across workers") {
+  const auto level_count = GENERATE(std::size_t{1}, std::size_t{4});
+  const auto pixels = make_random_pixels(200000, 300, 100, 1);
+  auto single_worker = boni::parallel::worker_pool{1};
+  auto single = boni::pixel_occupancy::grid{};
+  single.reset(300, 100, level_count);
+  auto workers = boni::parallel::worker_pool{4};
+  auto parallel = boni::pixel_occupancy::grid{};
+  parallel.reset(300, 100, level_count);
+  const auto expected = list_occupied(single, pixels, single_worker);
+  REQUIRE(!expected.empty());
+  REQUIRE(expected.size() <= 300 * 100);
+  REQUIRE(list_occupied(parallel, pixels, workers) == expected);
+  REQUIRE(parallel.level_sizes() == single.level_sizes());
+}
+
+TEST_CASE("pixel_occupancy forgets the marks of the last reset") {
+  const auto level_count = GENERATE(std::size_t{1}, std::size_t{4});
+  auto workers = boni::parallel::worker_pool{4};
+  auto occupancy = boni::pixel_occupancy::grid{};
+  occupancy.reset(300, 100, level_count);
+  REQUIRE(
+      list_occupied(
+          occupancy, make_random_pixels(200000, 300, 100, 2), workers)
+          .size() > 1);
+  occupancy.reset(300, 100, level_count);
+  REQUIRE(
+      list_occupied(occupancy, {{5, 7}, {5, 7}}, workers) ==
+      std::vector<pixel>{{5, 7}});
+  // Two hits, unless counts of the last reset were kept.
+  REQUIRE(occupancy.level_sizes()[level_count > 1 ? 1 : 0] == 1);
+}
@@ -0,0 +1,175 @@
+// Corresponding headers.
+#include <boni/quad_tree.hpp>
+
+// Internal headers.
+#include <random_geometry.hpp>
+
+// External libraries.
+#include <catch.hpp>
+
+// Standard libraries.
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using pair_list = std::vector<std::pair<std::size_t, std::size_t>>;
+
+auto find_pairs_brute_force(
+    const std::vector<boni::quad_tree::point>& points, int radius)
+    -> pair_list {
+  auto pairs = pair_list{};
+  const auto radius_squared = std::int64_t{radius} * radius;
+  for (std::size_t first = 0; first < points.size(); ++first) {
+    for (auto second = first + 1; second < points.size(); ++second) {
+      if (boni::quad_tree::distance_squared(
+              points[first], points[second]) <= radius_squared) {
+        pairs.emplace_back(first, second);
+      }
+    }
+  }
+  return pairs;
+}
+
+auto find_pairs(
+    const std::vector<boni::quad_tree::point>& points, int radius,
+    unsigned worker_count) -> pair_list {
+  auto index = boni::quad_tree::tree{};
+  index.build(points);
+  auto pairs_per_worker = std::vector<pair_list>(worker_count);
+  boni::quad_tree::for_each_pair_within(
+      index, radius,
+      [&pairs_per_worker](
+          std::size_t worker, std::size_t first, std::size_t second) {
+        pairs_per_worker[worker].emplace_back(
+            std::min(first, second), std::max(first, second));
+      },
+      worker_count);
+  auto pairs = pair_list{};
+  for (const auto& worker_pairs : pairs_per_worker) {
+    pairs.insert(
+        pairs.end(), worker_pairs.cbegin(), worker_pairs.cend());
+  }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+} // namespace
+
+TEST_CASE("quad_tree of no points has no nodes") {
+  auto index = boni::quad_tree::tree{};
+  index.build({});
+  REQUIRE(index.empty());
+  REQUIRE(index.nodes().empty());
+  REQUIRE(find_pairs({}, 10, 1).empty());
+}
+
+TEST_CASE("quad_tree keeps every point in exactly one leaf") {
+  const auto points = make_random_points(1000, 100, 1);
+  auto index = boni::quad_tree::tree{4};
+  index.build(points);
+  auto covered = std::size_t{0};
+  for (const auto leaf : index.leaves()) {
+    const auto& node = index.nodes()[leaf];
+    REQUIRE(node.child_count == 0);
+    REQUIRE(node.begin == covered);
+    covered = node.end;
+  }
+  REQUIRE(covered == points.size());
+  for (std::size_t position = 0; position < points.size(); ++position) {
+    const auto original = index.indices()[position];
+    REQUIRE(index.points()[position] == points[original]);
+  }
+}
+
+TEST_CASE("quad_tree splits no further than coincident points") {
+  const auto points = std::vector<boni::quad_tree::point>(100, {-3, 7});
+  auto index = boni::quad_tree::tree{4};
+  index.build(points);
+  REQUIRE(index.leaves().size() == 1);
+  REQUIRE(find_pairs(points, 0, 1).size() == 100 * 99 / 2);
+}
+
+TEST_CASE("for_each_pair_within matches brute force") {
+  const auto points = make_random_points(2000, 500, 2);
+  const auto radius = GENERATE(0, 5, 20, 100);
+  const auto expected = find_pairs_brute_force(points, radius);
+  REQUIRE(find_pairs(points, radius, 1) == expected);
+}
+
+TEST_CASE("for_each_pair_within matches brute force across workers") {
+  const auto points = make_random_points(2000, 500, 3);
+  const auto expected = find_pairs_brute_force(points, 30);
+  REQUIRE(find_pairs(points, 30, 4) == expected);
+}
+
+TEST_CASE("distance_squared saturates at opposite ends of the range") {
+  constexpr auto min = std::numeric_limits<int>::min();
+  constexpr auto max = std::numeric_limits<int>::max();
+  constexpr auto saturated = std::numeric_limits<std::int64_t>::max();
+  using boni::quad_tree::box;
+  using boni::quad_tree::distance_squared;
+  using boni::quad_tree::point;
+  REQUIRE(distance_squared(point{min, 0}, point{max, 0}) == saturated);
+  REQUIRE(
+      distance_squared(point{min, min}, point{max, max}) == saturated);
+  REQUIRE(
+      distance_squared(point{min, 0}, point{-1, 0}) ==
+      std::int64_t{max} * max);
+  REQUIRE(
+      distance_squared(
+          box{{min, min}, {min, min}}, box{{max, max}, {max, max}}) ==
+      saturated);
+}
+
+TEST_CASE("for_each_pair_within handles extreme coordinates") {
+  constexpr auto min = std::numeric_limits<int>::min();
+  constexpr auto max = std::numeric_limits<int>::max();
+  const auto points = std::vector<boni::quad_tree::point>{
+      {min, 0}, {max, 0}, {max - 1, 0}, {min, min}, {max, max}};
+  REQUIRE(find_pairs(points, max, 1) == pair_list{{1, 2}, {1, 4}});
+}
+
+TEST_CASE("for_each_pair_within reports nothing for negative radius") {
+  const auto points = make_random_points(10, 1, 4);
+  REQUIRE(find_pairs(points, -1, 1).empty());
+}
+
+TEST_CASE("for_each_pair_within finds every pair near a region") {
+  const auto points = make_random_points(2000, 500, 5);
+  const auto region = boni::quad_tree::box{{-100, 0}, {50, 200}};
+  constexpr auto radius = 20;
+  auto index = boni::quad_tree::tree{};
+  index.build(points);
+  auto workers = boni::parallel::worker_pool{1};
+  auto pairs = pair_list{};
+  boni::quad_tree::for_each_pair_within(
+      index, radius,
+      [&pairs](std::size_t /*worker*/, std::size_t first,
+               std::size_t second) {
+        pairs.emplace_back(
+            std::min(first, second), std::max(first, second));
+      },
+      workers, region);
+  std::sort(pairs.begin(), pairs.end());
+  const auto all_pairs = find_pairs_brute_force(points, radius);
+  REQUIRE(pairs.size() < all_pairs.size());
+  REQUIRE(std::includes(
+      all_pairs.cbegin(), all_pairs.cend(), pairs.cbegin(),
+      pairs.cend()));
+  const auto is_in_region = [&](std::size_t point) {
+    return boni::quad_tree::distance_squared(
+               boni::quad_tree::box{points[point], points[point]},
+               region) == 0;
+  };
+  for (const auto& [first, second] : all_pairs) {
+    if (is_in_region(first) || is_in_region(second)) {
+      REQUIRE(std::binary_search(
+          pairs.cbegin(), pairs.cend(), std::pair{first, second}));
+    }
+  }
+}
@@ -0,0 +1,61 @@
+// Corresponding headers.
+#include <boni/worker_pool.hpp>
+
+// External libraries.
+#include <catch.hpp>
+
+// Standard libraries.
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+TEST_CASE("worker_pool runs every worker once per run") {
+  auto workers = boni::parallel::worker_pool{4};
+  REQUIRE(workers.worker_count() == 4);
+  auto runs = std::vector<std::atomic<int>>(4);
+  for (auto run = 0; run < 100; ++run) {
+    workers.run(4, [&runs](std::size_t worker) { ++runs[worker]; });
+  }
+  for (const auto& count : runs) {
+    REQUIRE(count == 100);
+  }
+}
+
+TEST_CASE("worker_pool caps the threads at its worker count") {
+  auto workers = boni::parallel::worker_pool{2};
+  auto highest_worker = std::atomic<std::size_t>{0};
+  auto run_count = std::atomic<int>{0};
+  workers.run(8, [&](std::size_t worker) {
+    ++run_count;
+    auto highest = highest_worker.load();
+    while (highest < worker &&
+           !highest_worker.compare_exchange_weak(highest, worker)) {
+    }
+  });
+  REQUIRE(run_count == 2);
+  REQUIRE(highest_worker == 1);
+}
+
+TEST_CASE("worker_pool runs a single worker on the calling thread") {
+  auto workers = boni::parallel::worker_pool{4};
+  auto thread_id = std::thread::id{};
+  workers.run(1, [&thread_id](std::size_t /*worker*/) {
+    thread_id = std::this_thread::get_id();
+  });
+  REQUIRE(thread_id == std::this_thread::get_id());
+}
+
+TEST_CASE("worker_pool lets runs from different threads take turns") {
+  auto workers = boni::parallel::worker_pool{3};
+  auto total = std::atomic<int>{0};
+  const auto run_many = [&] {
+    for (auto run = 0; run < 50; ++run) {
+      workers.run(3, [&total](std::size_t /*worker*/) { ++total; });
+    }
+  };
+  auto other = std::thread{run_many};
+  run_many();
+  other.join();
+  REQUIRE(total == 2 * 50 * 3);
+}
@@ -0,0 +1,112 @@
+// Corresponding headers.
+#include <event_recording.hpp>
+
+// External libraries.
+#include <catch.hpp>
+
+// Standard libraries.
+#include <vector>
+
+namespace {
+
+auto open_temporary_file() -> File {
+  auto file = File{std::tmpfile()};
+  REQUIRE(file.get() != nullptr);
+  return file;
+}
+
+} // namespace
+
+TEST_CASE("recorded events read back as written") {
+  const auto recorded_events = std::vector<RecordedEvent>{
+      {RecordedEventType::mouse_button_down, 10, SDL_BUTTON_LEFT, 1, 2},
+      {RecordedEventType::mouse_motion, 11, 0, -3, 4},
+      {RecordedEventType::mouse_wheel, 12, 0, 0, -1},
+      {RecordedEventType::mouse_button_up, 13, SDL_BUTTON_RIGHT, 5, 6},
+      {RecordedEventType::frame_end, 14},
+  };
+  auto file = open_temporary_file();
+  REQUIRE(write_recording_header(file));
+  for (const auto& recorded_event : recorded_events) {
+    REQUIRE(write_recorded_event(file, recorded_event));
+  }
+
+  std::rewind(file);
+  REQUIRE(read_recording_header(file));
+  auto actual = RecordedEvent{};
+  for (const auto& expected : recorded_events) {
+    REQUIRE(
+        read_recorded_event(file, actual) == RecordReadStatus::event);
+    REQUIRE(actual.type == expected.type);
+    REQUIRE(actual.timestamp == expected.timestamp);
+    REQUIRE(actual.button == expected.button);
+    REQUIRE(actual.x == expected.x);
+    REQUIRE(actual.y == expected.y);
+  }
+  REQUIRE(
+      read_recorded_event(file, actual) ==
+      RecordReadStatus::end_of_file);
+}
+
+TEST_CASE("recording without header is rejected") {
+  auto file = open_temporary_file();
+  REQUIRE(write_recorded_event(file, {RecordedEventType::frame_end, 1}));
+  std::rewind(file);
+  REQUIRE(!read_recording_header(file));
+}
+
+TEST_CASE("truncated recorded event is malformed") {
+  auto file = open_temporary_file();
+  REQUIRE(write_recorded_event(
+      file, {RecordedEventType::mouse_motion, 1, 0, 2, 3}));
+  std::fflush(file);
+  const auto size = std::ftell(file);
+  std::rewind(file);
+  auto truncated = open_temporary_file();
+  for (auto index = 0L; index + 1 < size; ++index) {
+    std::fputc(std::fgetc(file), truncated);
+  }
+  std::rewind(truncated);
+  auto recorded_event = RecordedEvent{};
+  REQUIRE(
+      read_recorded_event(truncated, recorded_event) ==
+      RecordReadStatus::malformed);
+}
+
+TEST_CASE("recorded event of unknown type is malformed") {
+  auto file = open_temporary_file();
+  REQUIRE(
+      write_recorded_event(file, {RecordedEventType::frame_end, 1}));
+  std::rewind(file);
+  std::fputc(0xff, file);
+  std::rewind(file);
+  auto recorded_event = RecordedEvent{};
+  REQUIRE(
+      read_recorded_event(file, recorded_event) ==
+      RecordReadStatus::malformed);
+}
+
+TEST_CASE("mouse events convert to records and back") {
+  SDL_Event event{};
+  event.type = SDL_MOUSEBUTTONDOWN;
+  event.button.timestamp = 42;
+  event.button.button = SDL_BUTTON_RIGHT;
+  event.button.x = 7;
+  event.button.y = 8;
+  const auto recorded_event = to_recorded_event(event);
+  REQUIRE(recorded_event.has_value());
+
+  const auto replayed_event = to_sdl_event(*recorded_event, 3);
+  REQUIRE(replayed_event.type == SDL_MOUSEBUTTONDOWN);
+  REQUIRE(replayed_event.button.timestamp == 42);
+  REQUIRE(replayed_event.button.windowID == 3);
+  REQUIRE(replayed_event.button.button == SDL_BUTTON_RIGHT);
+  REQUIRE(replayed_event.button.x == 7);
+  REQUIRE(replayed_event.button.y == 8);
+}
+
+TEST_CASE("non-mouse events are not recorded") {
+  SDL_Event event{};
+  event.type = SDL_QUIT;
+  REQUIRE(!to_recorded_event(event).has_value());
+}
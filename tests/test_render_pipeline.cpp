@@ -0,0 +1,143 @@
+// Corresponding headers.
+#include <render_pipeline.hpp>
+
+// Internal headers.
+#include <sample_render_state.hpp>
+
+// External libraries.
+#include <catch.hpp>
+
+// Standard libraries.
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+namespace {
+
+// Waits for the worker to prepare a frame and moves it to the front.
+auto take_prepared_frame_within_timeout(RenderPipeline& pipeline)
+    -> bool {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds{10};
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (pipeline.take_prepared_frame()) {
+      return true;
+    }
+    std::this_thread::yield();
+  }
+  return false;
+}
+
+} // namespace
+
+TEST_CASE("RenderPipeline prepares the requested frame") {
+  auto prepared_count = std::atomic<int>{0};
+  auto pipeline =
+      RenderPipeline{[&prepared_count] { ++prepared_count; }};
+  auto state = make_render_state();
+  state.camera.position = {5, 5};
+  REQUIRE(pipeline.request_frame(state));
+  REQUIRE(take_prepared_frame_within_timeout(pipeline));
+  REQUIRE(prepared_count == 1);
+
+  refresh_render_cache(state);
+  const auto& front = pipeline.front();
+  REQUIRE(front.draw_points.size() == state.draw_points.size());
+  const auto& draw_points = state.draw_points;
+  for (std::size_t index = 0; index < draw_points.size(); ++index) {
+    const auto expected = draw_points[index];
+    REQUIRE(front.draw_points[index].x == expected.x);
+    REQUIRE(front.draw_points[index].y == expected.y);
+  }
+}
+
+TEST_CASE("RenderPipeline shows a camera change in the next frame") {
+  auto pipeline = RenderPipeline{nullptr};
+  auto state = make_render_state();
+  REQUIRE(pipeline.request_frame(state));
+  REQUIRE(take_prepared_frame_within_timeout(pipeline));
+  REQUIRE(pipeline.front().draw_points[0].x == 0);
+
+  // Moves the first column of positions out of view.
+  state.camera.position = {4, 0};
+  REQUIRE(pipeline.request_frame(state));
+  REQUIRE(take_prepared_frame_within_timeout(pipeline));
+  REQUIRE(pipeline.front().draw_points[0].x == 4);
+  REQUIRE(pipeline.front().draw_points[0].y == 0);
+}
+
+TEST_CASE("RenderPipeline refuses requests until prepared is taken") {
+  auto pipeline = RenderPipeline{nullptr};
+  const auto state = make_render_state();
+  REQUIRE(pipeline.request_frame(state));
+  REQUIRE(!pipeline.request_frame(state));
+  REQUIRE(take_prepared_frame_within_timeout(pipeline));
+  REQUIRE(pipeline.request_frame(state));
+}
+
+TEST_CASE("RenderPipeline shows a shape change in the next frames") {
+  auto pipeline = RenderPipeline{nullptr};
+  auto state = make_render_state();
+  REQUIRE(pipeline.request_frame(state));
+  REQUIRE(take_prepared_frame_within_timeout(pipeline));
+  const auto rectangle_count = pipeline.front().draw_rectangles.size();
+
+  state.rectangles.push_back({{30, 30}, {40, 40}});
+  ++state.shape_revision;
+  // Both copies must pick up the change.
+  for (auto frame = 0; frame < 2; ++frame) {
+    REQUIRE(pipeline.request_frame(state));
+    REQUIRE(take_prepared_frame_within_timeout(pipeline));
+    REQUIRE(
+        pipeline.front().draw_rectangles.size() == rectangle_count + 1);
+  }
+}
+
+TEST_CASE("RenderPipeline waits for the requested frame") {
+  auto pipeline = RenderPipeline{nullptr};
+  auto state = make_render_state();
+  for (auto x = 0; x < 3; ++x) {
+    state.camera.position = {x, 0};
+    REQUIRE(pipeline.request_frame(state));
+    pipeline.wait_for_prepared_frame();
+    REQUIRE(pipeline.front().camera.position[0] == x);
+  }
+}
+
+TEST_CASE("RenderPipeline wakes a parked worker") {
+  auto pipeline = RenderPipeline{nullptr};
+  const auto state = make_render_state();
+  for (auto frame = 0; frame < 3; ++frame) {
+    // Long enough for the worker to give up spinning and park.
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    REQUIRE(pipeline.request_frame(state));
+    REQUIRE(take_prepared_frame_within_timeout(pipeline));
+  }
+}
+
+TEST_CASE("RenderPipeline copies positions on a new revision") {
+  auto pipeline = RenderPipeline{nullptr};
+  auto state = make_render_state();
+  // Fills both copies.
+  for (auto frame = 0; frame < 2; ++frame) {
+    REQUIRE(pipeline.request_frame(state));
+    REQUIRE(take_prepared_frame_within_timeout(pipeline));
+  }
+  const auto point_count = pipeline.front().draw_points.size();
+
+  // Between grid positions, so it covers a pixel of its own.
+  state.positions.push_back({4, 4});
+  for (auto frame = 0; frame < 2; ++frame) {
+    REQUIRE(pipeline.request_frame(state));
+    REQUIRE(take_prepared_frame_within_timeout(pipeline));
+    // Not copied until the revision changes.
+    REQUIRE(pipeline.front().draw_points.size() == point_count);
+  }
+  ++state.position_revision;
+  for (auto frame = 0; frame < 2; ++frame) {
+    REQUIRE(pipeline.request_frame(state));
+    REQUIRE(take_prepared_frame_within_timeout(pipeline));
+    REQUIRE(pipeline.front().draw_points.size() == point_count + 1);
+  }
+}
@@ -0,0 +1,285 @@
+// Corresponding headers.
+#include <render_state.hpp>
+
+// Internal headers.
+#include <sample_render_state.hpp>
+
+// External libraries.
+#include <catch.hpp>
+
+// Standard libraries.
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+// Counts every heap allocation made by the test executable,
+// so that tests can assert that some code does not allocate at all,
+// including through allocators that are not accounted for.
+
+namespace {
+
+std::atomic<std::size_t> heap_allocation_count{0};
+
+} // namespace
+
+auto operator new(std::size_t byte_count) -> void* {
+  heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  auto* const pointer = std::malloc(byte_count == 0 ? 1 : byte_count);
+  if (pointer != nullptr) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(
+    void* pointer, std::size_t /*byte_count*/) noexcept {
+  std::free(pointer);
+}
+
+TEST_CASE("refresh_render_cache does not allocate once warmed up") {
+  auto state = make_render_state();
+  state.is_neighbour_lines_shown = true;
+  // As shipped, with every render worker taking part.
+  REQUIRE(
+      state.neighbour_pairs.size() ==
+      get_render_workers().worker_count());
+  refresh_render_cache(state);
+  REQUIRE(!state.draw_points.empty());
+  REQUIRE(!state.neighbour_line_points.empty());
+  REQUIRE(!state.draw_rectangles.empty());
+  REQUIRE(!state.segment_polyline_points.empty());
+
+  const auto before = heap_allocation_count.load();
+  refresh_render_cache(state);
+  REQUIRE(heap_allocation_count.load() == before);
+}
+
+TEST_CASE("refresh_render_cache transforms every visible position") {
+  auto state = make_render_state();
+  state.camera.position = {8, 16};
+  refresh_render_cache(state);
+  // Columns 1 to 99 and rows 2 to 91 are in the viewport.
+  REQUIRE(state.draw_points.size() == 99 * 90);
+  REQUIRE(state.draw_points[0].x == 0);
+  REQUIRE(state.draw_points[0].y == 0);
+  REQUIRE(state.draw_points[1].x == 8);
+  REQUIRE(state.draw_points[1].y == 0);
+}
+
+TEST_CASE("refresh_render_cache draws each pixel at most once") {
+  auto state = make_render_state();
+  state.is_point_intensity_shown = GENERATE(false, true);
+  state.camera.zoom_level = 50;
+  refresh_render_cache(state);
+  // Every position lands in one of few pixels near the corner.
+  REQUIRE(!state.draw_points.empty());
+  REQUIRE(state.draw_points.size() <= 5 * 5);
+  for (std::size_t first = 0; first < state.draw_points.size();
+       ++first) {
+    for (auto second = first + 1; second < state.draw_points.size();
+         ++second) {
+      const auto left = state.draw_points[first];
+      const auto right = state.draw_points[second];
+      REQUIRE((left.x != right.x || left.y != right.y));
+    }
+  }
+}
+
+TEST_CASE("refresh_render_cache groups overlapping points by count") {
+  auto state = RenderState{};
+  state.viewport_size = {10, 10};
+  state.is_point_intensity_shown = true;
+  state.positions.assign(3, {5, 5});
+  state.positions.push_back({1, 1});
+  refresh_render_cache(state);
+  REQUIRE(state.draw_points.size() == 2);
+  REQUIRE(state.draw_points[0].x == 1);
+  REQUIRE(state.draw_points[1].x == 5);
+  const auto& level_sizes = state.point_occupancy.level_sizes();
+  REQUIRE(level_sizes.size() == POINT_INTENSITY_LEVEL_COUNT);
+  REQUIRE(level_sizes[0] == 1);
+  REQUIRE(level_sizes[1] == 1);
+}
+
+TEST_CASE("refresh_render_cache skips neighbour lines when zoomed out") {
+  auto state = make_render_state();
+  state.is_neighbour_lines_shown = true;
+  state.camera.zoom_level = 1;
+  refresh_render_cache(state);
+  REQUIRE(state.neighbour_line_points.empty());
+}
+
+TEST_CASE("refresh_render_cache skips neighbour lines unless shown") {
+  auto state = make_render_state();
+  refresh_render_cache(state);
+  REQUIRE(state.neighbour_line_points.empty());
+  REQUIRE(state.position_index.empty());
+  state.is_neighbour_lines_shown = true;
+  refresh_render_cache(state);
+  REQUIRE(!state.neighbour_line_points.empty());
+}
+
+TEST_CASE("refresh_render_cache indexes positions per revision") {
+  auto state = RenderState{};
+  state.viewport_size = {100, 100};
+  state.is_neighbour_lines_shown = true;
+  state.positions.push_back({10, 10});
+  state.positions.push_back({20, 10});
+  refresh_render_cache(state);
+  REQUIRE(state.neighbour_line_points.size() == 2);
+
+  // Not indexed until the revision changes.
+  state.positions.push_back({30, 10});
+  refresh_render_cache(state);
+  REQUIRE(state.neighbour_line_points.size() == 2);
+  ++state.position_revision;
+  refresh_render_cache(state);
+  REQUIRE(state.neighbour_line_points.size() == 6);
+}
+
+TEST_CASE("refresh_render_cache accounts draw points to render cache") {
+  auto state = make_render_state();
+  const auto before =
+      boni::allocation::counter_of<RenderCacheMemory>.load().live_bytes;
+  refresh_render_cache(state);
+  const auto after =
+      boni::allocation::counter_of<RenderCacheMemory>.load().live_bytes;
+  REQUIRE(
+      after - before >= state.draw_points.size() * sizeof(SDL_Point));
+}
+
+TEST_CASE("refresh_render_cache culls shapes outside the viewport") {
+  auto state = RenderState{};
+  state.viewport_size = {100, 100};
+  state.rectangles.push_back({{10, 10}, {20, 20}});
+  state.rectangles.push_back({{200, 10}, {220, 20}});
+  state.rectangles.push_back({{-50, -50}, {0, 0}});
+  state.segments.push_back({{-10, 50}, {-5, 50}});
+  state.segments.push_back({{50, 50}, {150, 50}});
+  refresh_render_cache(state);
+  REQUIRE(state.draw_rectangles.size() == 2);
+  REQUIRE(state.segment_polyline_sizes.size() == 1);
+}
+
+TEST_CASE("refresh_render_cache joins connected segments") {
+  auto state = RenderState{};
+  state.viewport_size = {100, 100};
+  state.segments.push_back({{0, 0}, {10, 0}});
+  state.segments.push_back({{10, 0}, {10, 10}});
+  state.segments.push_back({{10, 10}, {0, 10}});
+  state.segments.push_back({{50, 50}, {60, 60}});
+  refresh_render_cache(state);
+  REQUIRE(state.segment_polyline_sizes.size() == 2);
+  REQUIRE(state.segment_polyline_sizes[0] == 4);
+  REQUIRE(state.segment_polyline_sizes[1] == 2);
+  REQUIRE(state.segment_polyline_points.size() == 6);
+}
+
+TEST_CASE("refresh_render_cache culls shapes when zoomed out far") {
+  auto state = make_render_state();
+  state.positions.clear();
+  // The viewport spans far more than the range of `int`.
+  state.camera.zoom_level = 400;
+  REQUIRE_NOTHROW(refresh_render_cache(state));
+  REQUIRE(state.draw_rectangles.size() == state.rectangles.size());
+}
+
+TEST_CASE("refresh_render_cache clips shapes when zoomed in far") {
+  constexpr auto min = std::numeric_limits<int>::min();
+  constexpr auto max = std::numeric_limits<int>::max();
+  auto state = RenderState{};
+  state.viewport_size = {100, 100};
+  state.camera.zoom_level = -400;
+  state.rectangles.push_back({{min, min}, {max, max}});
+  state.segments.push_back({{min, 0}, {max, 0}});
+  state.segments.push_back({{max, 0}, {max, max}});
+  REQUIRE_NOTHROW(refresh_render_cache(state));
+  REQUIRE(state.draw_rectangles.size() == 1);
+  const auto& rectangle = state.draw_rectangles.front();
+  REQUIRE(rectangle.x <= 0);
+  REQUIRE(rectangle.y <= 0);
+  REQUIRE(rectangle.x + rectangle.w >= 100);
+  REQUIRE(rectangle.y + rectangle.h >= 100);
+  // The second segment is out of view.
+  REQUIRE(state.segment_polyline_sizes.size() == 1);
+  REQUIRE(state.segment_polyline_points.size() == 2);
+}
+
+TEST_CASE("refresh_render_cache splits polylines where clipped") {
+  auto state = RenderState{};
+  state.viewport_size = {100, 100};
+  // Leaves the viewport and comes back.
+  state.segments.push_back({{10, 10}, {200, 10}});
+  state.segments.push_back({{200, 10}, {10, 20}});
+  refresh_render_cache(state);
+  REQUIRE(state.segment_polyline_sizes.size() == 2);
+  REQUIRE(state.segment_polyline_points.size() == 4);
+}
+
+TEST_CASE("refresh_render_cache keeps neighbour lines in view") {
+  auto state = RenderState{};
+  state.viewport_size = {100, 100};
+  state.is_neighbour_lines_shown = true;
+  // Enough off-screen pairs to fill the cap of every worker.
+  for (auto x = 0; x < 20000; ++x) {
+    state.positions.push_back({x - 100000, -100000});
+  }
+  state.positions.push_back({10, 10});
+  state.positions.push_back({20, 10});
+  refresh_render_cache(state);
+  REQUIRE(state.neighbour_line_points.size() == 2);
+}
+
+TEST_CASE("refresh_render_cache clips neighbour lines when zoomed in") {
+  auto state = RenderState{};
+  state.viewport_size = {100, 100};
+  state.is_neighbour_lines_shown = true;
+  state.camera.zoom_level = -200;
+  // The second point is far outside the viewport.
+  state.positions.push_back({0, 0});
+  state.positions.push_back({20, 0});
+  REQUIRE_NOTHROW(refresh_render_cache(state));
+  REQUIRE(state.neighbour_line_points.size() == 2);
+  REQUIRE(state.neighbour_line_points[1].x <= 101);
+}
+
+TEST_CASE("refresh_render_cache reindexes shapes on a new revision") {
+  auto state = RenderState{};
+  state.viewport_size = {100, 100};
+  state.rectangles.push_back({{10, 10}, {20, 20}});
+  refresh_render_cache(state);
+  REQUIRE(state.draw_rectangles.size() == 1);
+
+  // Not indexed until the revision changes.
+  state.rectangles.push_back({{30, 30}, {40, 40}});
+  refresh_render_cache(state);
+  REQUIRE(state.draw_rectangles.size() == 1);
+  ++state.shape_revision;
+  refresh_render_cache(state);
+  REQUIRE(state.draw_rectangles.size() == 2);
+}
+
+TEST_CASE("refresh_render_cache culls positions at extreme values") {
+  constexpr auto min = std::numeric_limits<int>::min();
+  constexpr auto max = std::numeric_limits<int>::max();
+  auto state = RenderState{};
+  state.viewport_size = {100, 100};
+  state.camera.position = {-10, 0};
+  state.positions.push_back({max, 0});
+  state.positions.push_back({min, max});
+  state.positions.push_back({0, 5});
+  refresh_render_cache(state);
+  REQUIRE(state.draw_points.size() == 1);
+  REQUIRE(state.draw_points[0].x == 10);
+
+  state.camera.position = {min, min};
+  state.positions.push_back({min + 1, min + 2});
+  refresh_render_cache(state);
+  REQUIRE(state.draw_points.size() == 1);
+  REQUIRE(state.draw_points[0].x == 1);
+  REQUIRE(state.draw_points[0].y == 2);
+}